@@ -0,0 +1,374 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+//Times every CPU preprocessing stage of a cloud on its own: parse, grid normals
+//of organized clouds, NaN removal, centering & scaling, Morton sort, normal
+//estimation, radii and vertex packing.
+//
+//USAGE: cube_bench [--csv results.csv] [--points target] [--synthetic [shape:]points[:seed]]... [cloud.ply|cloud.pcd]...
+//       cube_bench --mesh mesh.ply... [--points samples]
+//       cube_bench --write prefix --synthetic [shape:]points[:seed]...
+//       cube_bench --check
+//
+//Shapes are sphere, plane, terrain and mixture. --write streams the synthetic
+//clouds to binary PLY files instead, so they can be larger than the memory.
+
+#ifdef _MSC_VER
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "file.h"
+#include "vao.h"
+#include "generator.h"
+#include "meshsampler.h"
+
+using namespace std;
+
+
+ofstream csv;
+size_t targetPoints = 0; //decimation stage, only timed when set
+
+
+/**
+ @brief Peak resident memory of the process so far
+ @returns megabytes
+ */
+double peakMemoryMB()
+{
+#ifdef _MSC_VER
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0); //bytes
+#else
+    return usage.ru_maxrss / 1024.0;            //kilobytes
+#endif
+#endif
+}
+
+
+/**
+ @brief Prints and records one stage
+ @param dataset name of the cloud
+ @param stage name of the stage
+ @param points points processed by the stage
+ @param start time the stage began
+ */
+void report(string dataset, string stage, size_t points, std::chrono::steady_clock::time_point start)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double pointsPerSecond = (seconds > 0) ? points / seconds : 0;
+    double memory = peakMemoryMB();
+
+    cout << "  " << stage << ": " << seconds * 1000.0 << " ms, "
+         << pointsPerSecond << " points/s, peak " << memory << " MB" << endl;
+
+    if (csv.is_open())
+        csv << "\"" << dataset << "\",\"" << stage << "\"," << points << ","
+            << seconds * 1000.0 << "," << pointsPerSecond << "," << memory << endl;
+}
+
+
+/**
+ @brief Synthetic cloud from Generator, without normals nor radii so they have to be computed
+ @param spec shape, size & seed
+ @param points generated cloud
+ */
+void syntheticCloud(const generatorSpec &spec, PointStore &points)
+{
+    Generator::generate(spec, 0, spec.numOfPoints, points);
+
+    std::fill(points.nx.begin(), points.nx.end(), 0.0f);
+    std::fill(points.ny.begin(), points.ny.end(), 0.0f);
+    std::fill(points.nz.begin(), points.nz.end(), 0.0f);
+    floatArray().swap(points.radius);
+}
+
+
+/**
+ @brief Runs every stage after parsing on a cloud, as loadCloud does, except
+ that normals are always estimated
+ @param dataset name of the cloud
+ @param points cloud to process, moved into the VAO of the last stages
+ */
+void runStages(string dataset, PointStore &points)
+{
+    std::chrono::steady_clock::time_point start;
+
+    if (points.isOrganized()) {
+        start = std::chrono::steady_clock::now();
+        estimateGridNormals(points);
+        report(dataset, "Grid normals & radii", points.size(), start);
+
+        start = std::chrono::steady_clock::now();
+        buildGridMesh(points);
+        report(dataset, "Grid mesh", points.size(), start);
+    }
+
+    start = std::chrono::steady_clock::now();
+    removeNaNPoints(points);
+    report(dataset, "NaN removal", points.size(), start);
+
+    start = std::chrono::steady_clock::now();
+    float maxDistance = centerCloud(points);
+    scaleCloud(points, maxDistance);
+    report(dataset, "Centering & scaling", points.size(), start);
+
+    if (targetPoints > 0) {
+        size_t numOfPoints = points.size();
+        start = std::chrono::steady_clock::now();
+        decimateCloud(points, targetPoints);
+        report(dataset, "Voxel decimation", numOfPoints, start);
+    }
+
+    start = std::chrono::steady_clock::now();
+    sortMorton(points);
+    report(dataset, "Morton sort", points.size(), start);
+
+    start = std::chrono::steady_clock::now();
+    estimateNormals(points);
+    report(dataset, "Normal estimation", points.size(), start);
+
+    size_t numOfPoints = points.size();
+    size_t hostBytes = points.getBytes();
+    VAO vao(std::move(points));
+
+    start = std::chrono::steady_clock::now();
+    vao.computeRadius();
+    report(dataset, "Radii (computeRadius)", numOfPoints, start);
+
+    start = std::chrono::steady_clock::now();
+    vector<vaoGeometry> geometryData;
+    vector<vaoAppearance> appearanceData;
+    vao.packVertices(geometryData, appearanceData);
+    report(dataset, "Vertex packing", numOfPoints, start);
+
+    cout << "  Host store: " << hostBytes / (1024.0 * 1024.0) << " MB before radii, "
+         << vao.getPoints().getBytes() / (1024.0 * 1024.0) << " MB after" << endl;
+}
+
+
+/**
+ @brief Checks the vertex buffer chunking for counts past 2^31 and 2^32, where
+ 32-bit counts overflow, and packs a synthetic cloud spanning several buffers
+ @returns false if any check fails
+ */
+bool checkChunking()
+{
+    size_t perVBO = VAO::maxNumOfVertexByVBO();
+    size_t counts[] = {0, 1, perVBO - 1, perVBO, perVBO + 1, 3 * perVBO + 5,
+                       (1ULL << 31) - 1, (1ULL << 31) + 7, (1ULL << 32) + 5, 5000000000ULL, 12345678901ULL};
+    bool ok = true;
+
+    for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        size_t chunks = VAO::numOfVBORequired(counts[c]);
+        size_t total = 0;
+        bool sizes = true;
+
+        for (size_t i = 0; i < chunks; i++) {
+            size_t chunk = VAO::numOfVertexByVBO(counts[c], i);
+            sizes = sizes && chunk > 0 && chunk <= perVBO;
+            total += chunk;
+        }
+
+        if (total != counts[c] || !sizes || VAO::numOfVertexByVBO(counts[c], chunks) != 0) {
+            cout << "  Chunking of " << counts[c] << " points: FAILED" << endl;
+            ok = false;
+        }
+    }
+
+    //Past 2^31 points: every draw count fits a GLsizei, and
+    //chunk i starts at the global vertex i * perVBO, after every earlier chunk
+    size_t large[] = {(1ULL << 31) + 7, (1ULL << 32) + 5, 12345678901ULL};
+    for (unsigned int c = 0; c < sizeof(large) / sizeof(large[0]); c++) {
+        size_t first = 0;
+        bool fits = true;
+
+        for (size_t i = 0; i < VAO::numOfVBORequired(large[c]); i++) {
+            size_t chunk = VAO::numOfVertexByVBO(large[c], i);
+            fits = fits && first == VAO::maxNumOfVertexByVBO() * i &&
+                   chunk <= (size_t) INT_MAX;
+            first += chunk;
+        }
+
+        //Neighbour searches run on blocks PCL can index with int
+        size_t blocks = PointStore::numOfSearchBlocks(large[c]);
+        fits = fits && blocks > 1 && POINTSTORE_SEARCH_BLOCK <= (size_t) INT_MAX &&
+               large[c] - (blocks - 1) * POINTSTORE_SEARCH_BLOCK <= POINTSTORE_SEARCH_BLOCK;
+
+        if (first != large[c] || !fits) {
+            cout << "  Offsets & counts of " << large[c] << " points: FAILED" << endl;
+            ok = false;
+        }
+    }
+
+    //Packing of a cloud larger than one buffer
+    size_t numOfPoints = 3 * perVBO + 5;
+    generatorSpec spec = {SPHERE, numOfPoints, 0};
+    PointStore points;
+    syntheticCloud(spec, points);
+    points.radius.assign(numOfPoints, 0.01f);
+    float lastX = points.x[numOfPoints - 1];
+
+    VAO vao(std::move(points));
+    vector<vaoGeometry> geometryData;
+    vector<vaoAppearance> appearanceData;
+    vao.packVertices(geometryData, appearanceData);
+
+    size_t last = numOfPoints - 1;
+    if (geometryData.size() != numOfPoints || appearanceData.size() != numOfPoints ||
+        geometryData[last].position.x != lastX) {
+        cout << "  Packing of " << numOfPoints << " points: FAILED" << endl;
+        ok = false;
+    }
+
+    cout << "Chunking check " << (ok ? "passed." : "FAILED.") << endl;
+    return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+    vector<string> files;
+    vector<generatorSpec> synthetic;
+    string writePrefix;
+    vector<string> meshes;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc)
+            csv.open(argv[++i]);
+        else if (arg == "--check")
+            return checkChunking() ? 0 : 1;
+        else if (arg == "--points" && i + 1 < argc)
+            targetPoints = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--synthetic" && i + 1 < argc) {
+            generatorSpec spec;
+            if (Generator::parse(argv[++i], spec))
+                synthetic.push_back(spec);
+            else
+                cout << "Wrong synthetic cloud " << argv[i] << ", expected [shape:]points[:seed]" << endl;
+        }
+        else if (arg == "--mesh" && i + 1 < argc)
+            meshes.push_back(argv[++i]);
+        else if (arg == "--write" && i + 1 < argc)
+            writePrefix = argv[++i];
+        else
+            files.push_back(arg);
+    }
+
+    //Defaults: the test datasets and synthetic clouds of growing size
+    if (files.empty() && synthetic.empty() && meshes.empty()) {
+        files.push_back("../test/suzanne30k.ply");
+        files.push_back("../test/suzanne100k.ply");
+        files.push_back("../test/cow.ply");
+        generatorSpec small = {SPHERE, 1000000, 0}, large = {SPHERE, 10000000, 0};
+        synthetic.push_back(small);
+        synthetic.push_back(large);
+    }
+
+    if (!writePrefix.empty()) {
+        for (unsigned int i = 0; i < synthetic.size(); i++) {
+            string path = writePrefix + "_" + Generator::getShapeName(synthetic[i].shape)
+                        + "_" + to_string(synthetic[i].numOfPoints) + ".ply";
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (!Generator::writePLY(synthetic[i], path))
+                return 1;
+            report(path, "Generation & PLY writing", synthetic[i].numOfPoints, start);
+        }
+        return 0;
+    }
+
+    if (csv.is_open())
+        csv << "dataset,stage,points,ms,points_per_second,peak_mb" << endl;
+
+    for (unsigned int i = 0; i < files.size(); i++) {
+        cout << endl << files[i] << endl;
+
+        PointStore points;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!readCloud(files[i], points)) {
+            cout << "  Skipped." << endl;
+            continue;
+        }
+        report(files[i], "Parse", points.size(), start);
+
+        runStages(files[i], points);
+    }
+
+    for (unsigned int i = 0; i < synthetic.size(); i++) {
+        string dataset = "Synthetic " + Generator::getName(synthetic[i]);
+        cout << endl << dataset << endl;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        PointStore points;
+        syntheticCloud(synthetic[i], points);
+        report(dataset, "Generation", points.size(), start);
+
+        runStages(dataset, points);
+    }
+
+    //Mesh to surfels, --points samples
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        cout << endl << meshes[i] << endl;
+
+        triangleMesh mesh;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!MeshSampler::readMesh(meshes[i], mesh)) {
+            cout << "  Skipped." << endl;
+            continue;
+        }
+        report(meshes[i], "Mesh parse", mesh.indices.size() / 3, start);
+
+        size_t samples = (targetPoints > 0) ? targetPoints : MESH_DEFAULT_SAMPLES;
+        PointStore points;
+        start = std::chrono::steady_clock::now();
+        MeshSampler::normalizeMesh(mesh);
+        MeshSampler::sample(mesh, samples, 0, points);
+        report(meshes[i], "Mesh sampling", samples, start);
+    }
+
+    if (csv.is_open())
+        csv.close();
+
+    return 0;
+}
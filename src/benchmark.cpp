@@ -0,0 +1,259 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "benchmark.h"
+
+#include <chrono>
+#include <algorithm>
+
+#include "globals.h"
+#include "file.h"
+#include "shader.h"
+#include "light.h"
+#include "camera.h"
+#include "debugcameracallback.h"
+#include "residency.h"
+#include "progressive.h"
+#include "dynamicresolution.h"
+
+
+Benchmark::Benchmark(string outputPath, vector<string> clouds)
+{
+    this->outputPath = outputPath;
+    this->clouds = clouds;
+}
+
+
+void Benchmark::addResolution(int width, int height)
+{
+    benchmarkResolution resolution;
+    resolution.width = width;
+    resolution.height = height;
+    resolutions.push_back(resolution);
+}
+
+
+/**
+ @brief Renders the warm-up frames and then the measured ones, waiting for the
+ GPU at both ends so the whole orbit is inside the measure
+ @param window window being rendered
+ @param renderFrame renders, swaps and polls one frame
+ */
+void Benchmark::measure(GLFWwindow* window, void (*renderFrame)(GLFWwindow*))
+{
+    DebugCameraCallback* orbit = new DebugCameraCallback();
+    Camera::activeCamera->reset();
+    Camera::activeCamera->setUpdateCallback(orbit);
+    Light::resetAll();
+
+    for (int i = 0; i < BENCHMARK_WARMUP_FRAMES; i++)
+        renderFrame(window);
+
+    //The orbit starts again from the same place for every configuration
+    Camera::activeCamera->reset();
+    Camera::activeCamera->setUpdateCallback(NULL);
+    delete orbit;
+    orbit = new DebugCameraCallback();
+    Camera::activeCamera->setUpdateCallback(orbit);
+    Light::resetAll();
+
+    vector<double> frameTimes;
+    glFinish();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last = start;
+
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) {
+        renderFrame(window);
+
+        //Only the last frame is synchronized, the others overlap as in interactive use
+        if (i == BENCHMARK_FRAMES - 1)
+            glFinish();
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(now - last).count());
+        last = now;
+    }
+
+    double total = std::chrono::duration<double, std::milli>(last - start).count();
+
+    Camera::activeCamera->setUpdateCallback(NULL);
+    delete orbit;
+
+    sort(frameTimes.begin(), frameTimes.end());
+
+    output << BENCHMARK_FRAMES << ","
+           << total / BENCHMARK_FRAMES << ","
+           << frameTimes[frameTimes.size() / 2] << ","
+           << frameTimes.front() << ","
+           << frameTimes.back() << ","
+           << 1000.0 * BENCHMARK_FRAMES / total << endl;
+}
+
+
+/**
+ @brief Resizes the window, which the window manager may clamp or refuse
+ @param window window being rendered
+ @param resolution requested size
+ @param[out] width, height size display() renders at, the window size
+ @returns false, with a warning, if the window did not get the requested size
+ */
+bool Benchmark::setResolution(GLFWwindow* window, benchmarkResolution resolution, int &width, int &height)
+{
+    glfwSetWindowSize(window, resolution.width, resolution.height);
+    glfwPollEvents();
+    glfwGetWindowSize(window, &width, &height);
+
+    if (width != resolution.width || height != resolution.height) {
+        cout << "Benchmark: the window got " << width << "x" << height << " instead of "
+             << resolution.width << "x" << resolution.height << ", resolution skipped." << endl;
+        return false;
+    }
+
+    //On high DPI displays the framebuffer is larger than the window, only the window size is rendered
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    if (framebufferWidth != width || framebufferHeight != height)
+        cout << "Benchmark: framebuffer of " << framebufferWidth << "x" << framebufferHeight
+             << ", rendering " << width << "x" << height << " of it." << endl;
+
+    return true;
+}
+
+
+/**
+ @brief Runs the whole sweep
+ @param window window to render to, its size is changed for every resolution
+ @param renderFrame renders, swaps and polls one frame
+ @param resize framebuffer & camera resize, called after the window is resized
+ @returns false if the output file can not be created or no model is available
+ */
+bool Benchmark::run(GLFWwindow* window, void (*renderFrame)(GLFWwindow*), void (*resize)(GLFWwindow*, int, int))
+{
+    output.open(outputPath.c_str());
+    if (!output.is_open()) {
+        cout << "Can not open benchmark output " << outputPath << endl;
+        return false;
+    }
+
+    //Given clouds replace the built-in models, names follow the models loaded
+    vector<string> modelNames;
+    if (!clouds.empty()) {
+        Residency::releaseAll();
+        Globals::models.clear();
+        for (unsigned int i = 0; i < clouds.size(); i++) {
+            VAO model = loadCloud(clouds[i], Globals::pointBudget);
+            if (model.isValid()) {
+                Globals::models.push_back(std::move(model));
+                modelNames.push_back(clouds[i]);
+            }
+            else
+                cout << "Benchmark: can not load " << clouds[i] << ", skipped." << endl;
+        }
+    }
+    else {
+        for (unsigned int i = 0; i < Globals::models.size(); i++)
+            modelNames.push_back("Model " + to_string(i));
+    }
+
+    if (Globals::models.empty())
+        return false;
+
+    if (resolutions.empty()) {
+        addResolution(640, 480);
+        addResolution(1280, 720);
+        addResolution(1920, 1080);
+    }
+
+    //Vsync off, frames are not capped by the display
+    glfwSwapInterval(0);
+
+    //Every frame is timed with all the points at full resolution, the interactive
+    //settings are restored after the sweep
+    bool progressive = Progressive::isEnabled();
+    double frameTimeTarget = DynamicResolution::getTarget();
+    Progressive::setEnabled(false);
+    DynamicResolution::setTarget(0);
+
+    output << "model,points,shader,shading,lights,fxaa,width,height,frames,mean_ms,median_ms,min_ms,max_ms,fps" << endl;
+
+    for (unsigned int m = 0; m < Globals::models.size(); m++) {
+        //Normals & radii are estimated before any frame is timed, not in the
+        //background while the splats are drawn with zero radii
+        Globals::models[m].computeAttributes();
+        Globals::actualVAO = m;
+        Globals::displayVAO = Residency::use(m);
+        string modelName = modelNames[m];
+
+        for (unsigned int s = 0; s < Globals::listOfShaders.size(); s++) {
+            Globals::actualShader = s;
+
+            //-1 is the single pass shader, the rest its multipass variants
+            int variants = Globals::listOfShaders[s].getMultiPass().size();
+            for (int v = -1; v < variants; v++) {
+                Globals::MultipassEnabled = (v >= 0);
+                Globals::actualMultipass = (v >= 0) ? v : 0;
+                string shading = (v >= 0) ? Globals::listOfShaders[s].getDescription(v) : "Flat";
+
+                for (unsigned int l = 0; l < Globals::sceneLightsList.size(); l++) {
+                    Globals::sceneLightsArrIndex = l;
+
+                    for (int fxaa = 0; fxaa < 2; fxaa++) {
+                        Globals::FXAA = (fxaa == 1);
+
+                        for (unsigned int r = 0; r < resolutions.size(); r++) {
+                            int width, height;
+                            if (!setResolution(window, resolutions[r], width, height))
+                                continue;
+                            resize(window, width, height);
+
+                            cout << "Benchmark: " << modelName << " | " << Globals::listOfShaders[s].getDescription()
+                                 << " | " << shading << " | " << Globals::sceneLightsList[l].size() << " Lights | "
+                                 << (Globals::FXAA ? "FXAA" : "NONE") << " | "
+                                 << width << "x" << height << endl;
+
+                            output << "\"" << modelName << "\","
+                                   << Globals::displayVAO->getNumOfVertices() << ","
+                                   << "\"" << Globals::listOfShaders[s].getDescription() << "\","
+                                   << "\"" << shading << "\","
+                                   << Globals::sceneLightsList[l].size() << ","
+                                   << fxaa << ","
+                                   << width << "," << height << ",";
+
+                            measure(window, renderFrame);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Progressive::setEnabled(progressive);
+    DynamicResolution::setTarget(frameTimeTarget);
+
+    output.close();
+    return true;
+}
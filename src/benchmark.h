@@ -0,0 +1,77 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__benchmark__
+#define __CUBE__benchmark__
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#define BENCHMARK_WARMUP_FRAMES 20
+#define BENCHMARK_FRAMES 200    //one revolution of the debug camera orbit
+
+using namespace std;
+
+struct benchmarkResolution {
+    int width;
+    int height;
+};
+
+/**
+ @brief Unattended sweep over every model, shader, shading mode, light set, FXAA
+ state and resolution. Each configuration renders the deterministic debug camera
+ orbit with vsync off, after some warm-up frames, and appends a row to a CSV file.
+ */
+class Benchmark
+{
+
+private:
+    string outputPath;
+    vector<string> clouds;
+    vector<benchmarkResolution> resolutions;
+
+    ofstream output;
+
+    void measure(GLFWwindow* window, void (*renderFrame)(GLFWwindow*));
+    bool setResolution(GLFWwindow* window, benchmarkResolution resolution, int &width, int &height);
+
+public:
+
+    //Constructors
+    Benchmark(string outputPath, vector<string> clouds);
+
+    void addResolution(int width, int height);
+    bool run(GLFWwindow* window, void (*renderFrame)(GLFWwindow*), void (*resize)(GLFWwindow*, int, int));
+
+};
+
+#endif
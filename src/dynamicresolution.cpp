@@ -0,0 +1,170 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+
+#include "dynamicresolution.h"
+
+#include "camera.h"
+
+#include <math.h>
+
+double DynamicResolution::target = 0;
+float DynamicResolution::scale = 1.0f;
+float DynamicResolution::movingScale = 1.0f;
+double DynamicResolution::averageTime = 0;
+int DynamicResolution::stillFrames = 0;
+glm::mat4 DynamicResolution::lastView;
+long DynamicResolution::frame = 0;
+long DynamicResolution::nextResult = 0;
+GLuint DynamicResolution::queries[RESOLUTION_QUERIES][2];
+bool DynamicResolution::pending[RESOLUTION_QUERIES];
+bool DynamicResolution::timed = false;
+
+
+/**
+ @param milliseconds GPU frame time target, 0 disables the scaling and goes
+ back to full resolution
+ */
+void DynamicResolution::setTarget(double milliseconds)
+{
+    target = milliseconds;
+    if (!isEnabled()) {
+        scale = movingScale = 1.0f;
+        averageTime = 0;
+    }
+}
+
+
+/**
+ @param windowWidth, windowHeight size of the window
+ @param[out] width, height size the splat passes render at
+ */
+void DynamicResolution::renderSize(int windowWidth, int windowHeight, int &width, int &height)
+{
+    width = max((int) (windowWidth * scale + 0.5f), 1);
+    height = max((int) (windowHeight * scale + 0.5f), 1);
+}
+
+
+void DynamicResolution::beginFrame()
+{
+    if (!isEnabled())
+        return;
+
+    if (frame == 0)
+        for (int i = 0; i < RESOLUTION_QUERIES; i++)
+            glGenQueries(2, queries[i]);
+
+    //With the whole ring in flight, the GPU is far behind: this frame goes untimed
+    timed = !pending[frame % RESOLUTION_QUERIES];
+    if (timed)
+        glQueryCounter(queries[frame % RESOLUTION_QUERIES][0], GL_TIMESTAMP);
+}
+
+
+/**
+ @brief Closes the frame, then adapts the scale with the GPU time of every
+ earlier frame whose timestamps are available, oldest first
+ */
+void DynamicResolution::endFrame()
+{
+    if (!isEnabled())
+        return;
+
+    if (timed) {
+        glQueryCounter(queries[frame % RESOLUTION_QUERIES][1], GL_TIMESTAMP);
+        pending[frame % RESOLUTION_QUERIES] = true;
+    }
+
+    frame++;
+
+    for (; nextResult < frame; nextResult++) {
+        int slot = nextResult % RESOLUTION_QUERIES;
+        if (!pending[slot])
+            continue;
+
+        //The end timestamp is written last, the begin one is ready with it
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 begin, end;
+        glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+        pending[slot] = false;
+
+        adapt((end - begin) / 1.0e6);
+    }
+}
+
+
+/**
+ @param frameTime GPU milliseconds of the last resolved frame
+ */
+void DynamicResolution::adapt(double frameTime)
+{
+    bool moving = (Camera::viewMatrix != lastView);
+    lastView = Camera::viewMatrix;
+    stillFrames = moving ? 0 : stillFrames + 1;
+
+    averageTime = (averageTime > 0) ? averageTime * (1.0 - RESOLUTION_SMOOTHING) + frameTime * RESOLUTION_SMOOTHING
+                                    : frameTime;
+
+    if (stillFrames >= RESOLUTION_STILL_FRAMES) {
+        setScale(1.0f);
+        return;
+    }
+
+    //Motion starts again at the scale it left off
+    if (moving && stillFrames == 0 && scale != movingScale && scale == 1.0f) {
+        setScale(movingScale);
+        return;
+    }
+
+    //Cost follows the pixels, the square of the scale
+    float fit = scale * sqrt(target / averageTime);
+
+    if (fit < scale)
+        setScale(floor(fit / RESOLUTION_STEP) * RESOLUTION_STEP);
+    else if (fit >= scale + RESOLUTION_STEP && averageTime < target * RESOLUTION_GROW_MARGIN)
+        setScale(scale + RESOLUTION_STEP);
+
+    movingScale = scale;
+}
+
+
+void DynamicResolution::setScale(float newScale)
+{
+    newScale = min(max(newScale, RESOLUTION_MIN_SCALE), 1.0f);
+    if (newScale == scale)
+        return;
+
+    //The averaged time is predicted at the new scale
+    averageTime *= (newScale * newScale) / (scale * scale);
+    scale = newScale;
+}
@@ -0,0 +1,86 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+
+#ifndef __CUBE__dynamicresolution__
+#define __CUBE__dynamicresolution__
+
+#include <iostream>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#define RESOLUTION_MIN_SCALE 0.25f     //smallest side of the render size, relative to the window
+#define RESOLUTION_STEP 0.0625f        //scales are multiples of it, so size dependent buffers are seldom rebuilt
+#define RESOLUTION_SMOOTHING 0.25      //weight of the last frame in the averaged GPU time
+#define RESOLUTION_GROW_MARGIN 0.8     //the scale only grows with the averaged time under 80% of the target
+#define RESOLUTION_STILL_FRAMES 3      //frames without camera motion before returning to full resolution
+#define RESOLUTION_QUERIES 4           //frames of timestamps in flight before one is read
+
+using namespace std;
+
+/**
+ @brief Scales the render size of the splat passes to meet a GPU frame time
+ target while the camera moves, and returns to full resolution once the view
+ is still. Frame times come from a ring of GL_TIMESTAMP queries, read only
+ once available, so they never stall. Rendering cost is taken as proportional
+ to the pixels.
+ */
+class DynamicResolution {
+
+private:
+    DynamicResolution();
+
+    static double target;           //milliseconds, 0 disables the scaling
+    static float scale;             //of each side of the window
+    static float movingScale;       //scale reached while moving, resumed on the next motion
+    static double averageTime;      //milliseconds at the current scale
+    static int stillFrames;
+    static glm::mat4 lastView;
+
+    static long frame;
+    static long nextResult;         //oldest frame whose timestamps are not read yet
+    static GLuint queries[RESOLUTION_QUERIES][2]; //begin & end timestamps of each frame in flight
+    static bool pending[RESOLUTION_QUERIES];
+    static bool timed;              //the current frame got a slot of the ring
+
+    static void adapt(double frameTime);
+    static void setScale(float scale);
+
+public:
+    static void setTarget(double milliseconds);
+    static double getTarget() { return target; };
+    static bool isEnabled() { return target > 0; };
+    static float getScale() { return scale; };
+
+    static void renderSize(int windowWidth, int windowHeight, int &width, int &height);
+    static void beginFrame();
+    static void endFrame();
+
+};
+
+#endif
@@ -34,13 +34,19 @@
 #include <pcl/features/normal_3d_omp.h>
 #include <pcl/point_cloud.h>
 #include <pcl/console/parse.h>
-#include <pcl/common/transforms.h>
-#include <pcl/common/distances.h>
-#include <pcl/filters/filter.h>
-#include <pcl/filters/voxel_grid.h>
-#include <pcl/common/common.h> // added for getMaxDistance
 
 #include <fstream>
+#include <thread>
+#include <functional>
+#include <unordered_set>
+#include <stdint.h>
+#include <math.h>
+
+#define MORTON_BITS 21 //bits per axis, 63 bit keys
+#define RADIX_BITS 8   //key bits sorted in each pass
+#define VOXEL_SEARCH_STEPS 24       //bisection steps of the voxel size search
+#define VOXEL_SEARCH_TOLERANCE 0.02 //stop the search within 2% under the target
+#define GRID_MAX_JUMP 0.05          //grid neighbours farther than 5% of the range are across a depth discontinuity
 
 
 bool ends_with(const std::string &filename, const std::string &ext)
@@ -78,21 +84,17 @@ char* loadFile(string fname, GLint &fSize)
 }
 
 
-//Return VAO with .numOfTrianges = 0 && numOfVertices = 0 if error
-VAO loadCloud(string pathFile)
+bool readCloud(string pathFile, PointStore &points)
 {
-    typedef pcl::PointCloud<pcl::PointXYZRGBNormal> CloudType;
     CloudType::Ptr cloud (new CloudType);
 
-    VAO vao;
-
     //Open PCD or PLY files
     if (ends_with(pathFile, ".pcd"))
     {
         if (pcl::io::loadPCDFile (pathFile, *cloud) == -1) //* load the file
         {
             PCL_ERROR ("Couldn't read PCD file. \n");
-            return vao;
+            return false;
         }
     }
     else
@@ -101,70 +103,597 @@ VAO loadCloud(string pathFile)
             if (pcl::io::loadPLYFile (pathFile, *cloud) == -1) //* load the file
             {
                 PCL_ERROR ("Couldn't read PLY file. \n");
-                return vao;
+                return false;
             }
         }
 
+    points.fromPCL(*cloud);
+    return true;
+}
+
+
+void removeNaNPoints(PointStore &points)
+{
     cout << endl << "Removing NaN Points ..." << endl;
-    std::vector<int> indices;
-    int pointsBefore = cloud->size();
-    pcl::removeNaNFromPointCloud(*cloud, *cloud, indices);
+    size_t pointsBefore = points.size();
 
+    vector<size_t> finite;
+    finite.reserve(pointsBefore);
+    for (size_t i = 0; i < pointsBefore; i++)
+        if (std::isfinite(points.x[i]) && std::isfinite(points.y[i]) && std::isfinite(points.z[i]))
+            finite.push_back(i);
 
-    if (pointsBefore - cloud->size() > 0)
-        cout << "-> Deleted " << (pointsBefore - cloud->size()) << " NaN Points." << endl;
+    if (finite.size() < pointsBefore) {
+        points.reorder(finite);
+        cout << "-> Deleted " << (pointsBefore - points.size()) << " NaN Points." << endl;
+    }
 
-    cout << "Points: " << cloud->size() << endl;
+    cout << "Points: " << points.size() << endl;
+}
 
-    if (cloud->is_dense) {
 
-        //Move to origin
-        cout << endl << "Centering Cloud to origin ..." << endl;
-        CloudType::Ptr centeredCloud (new CloudType);
-        Eigen::Vector4f centroid;
-        pcl::compute3DCentroid (*cloud, centroid);
-        pcl::demeanPointCloud<pcl::PointXYZRGBNormal> (*cloud, centroid, *cloud);
+float centerCloud(PointStore &points)
+{
+    size_t numOfPoints = points.size();
+    if (numOfPoints == 0)
+        return 1.0f;
 
-        //Get MaxDistance for Scaling
-        cout << endl << "Scaling ..." << endl;
-        Eigen::Vector4f farestPoint;
-        pcl::compute3DCentroid(*cloud, centroid);
-        pcl::getMaxDistance(*cloud, centroid, farestPoint);
-        float maxDistance = max( max( abs(farestPoint.x()), abs(farestPoint.y()) ) , abs(farestPoint.z()) );
+    //Move to origin
+    cout << endl << "Centering Cloud to origin ..." << endl;
+    double cx = 0, cy = 0, cz = 0;
+    for (size_t i = 0; i < numOfPoints; i++) {
+        cx += points.x[i];
+        cy += points.y[i];
+        cz += points.z[i];
+    }
+    float centroid[] = {(float) (cx / numOfPoints), (float) (cy / numOfPoints), (float) (cz / numOfPoints)};
 
-        //Compute Normals if it's needed
-        cout << endl << "Analizing scene normals ..." << endl;
+    for (size_t i = 0; i < numOfPoints; i++) {
+        points.x[i] -= centroid[0];
+        points.y[i] -= centroid[1];
+        points.z[i] -= centroid[2];
+    }
+
+    //Get MaxDistance for Scaling, from the farthest point
+    cout << endl << "Scaling ..." << endl;
+    size_t farthest = 0;
+    float maxDistance = -1.0f;
+    for (size_t i = 0; i < numOfPoints; i++) {
+        float distance = points.x[i]*points.x[i] + points.y[i]*points.y[i] + points.z[i]*points.z[i];
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            farthest = i;
+        }
+    }
+    return max( max( abs(points.x[farthest]), abs(points.y[farthest]) ) , abs(points.z[farthest]) );
+}
 
-        bool isNeededNormalsEstimation = false;
-        for (size_t i = 0; i < cloud->points.size(); i++) {
-            //This normal is not valid.
-            if (cloud->points[i].normal_x == 0 && cloud->points[i].normal_y == 0 && cloud->points[i].normal_z == 0) {
-                cout << "-> Failed to find valid normals on the pointCloud." << endl;
-                isNeededNormalsEstimation = true;
-                break;
+
+//Axis aligned bounding box of the points
+static void boundingBox(PointStore &points, float minPoint[3], float maxPoint[3])
+{
+    const floatArray *axes[] = {&points.x, &points.y, &points.z};
+
+    for (int axis = 0; axis < 3; axis++) {
+        const floatArray &values = *axes[axis];
+        minPoint[axis] = values.empty() ? 0.0f : values[0];
+        maxPoint[axis] = minPoint[axis];
+        for (size_t i = 1; i < values.size(); i++) {
+            minPoint[axis] = min(minPoint[axis], values[i]);
+            maxPoint[axis] = max(maxPoint[axis], values[i]);
+        }
+    }
+}
+
+
+void parallelRanges(size_t count, unsigned int numOfThreads, function<void(size_t, size_t, unsigned int)> f)
+{
+    vector<thread> threads;
+    size_t rangeSize = (count + numOfThreads - 1) / numOfThreads;
+
+    for (unsigned int t = 0; t < numOfThreads; t++)
+        threads.push_back(thread(f, min(count, t * rangeSize), min(count, (t + 1) * rangeSize), t));
+
+    for (unsigned int t = 0; t < numOfThreads; t++)
+        threads[t].join();
+}
+
+
+//Spreads the lowest MORTON_BITS bits of v so there are two zero bits between each of them
+static uint64_t expandBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+    v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2)  & 0x1249249249249249ULL;
+    return v;
+}
+
+
+/**
+ @brief Stable LSD radix sort of keys, moving order along with them
+ @param keys sorted in place, only their lowest keyBits bits are used
+ @param order values carried by the keys
+ */
+static void radixSort(vector<uint64_t> &keys, vector<size_t> &order, int keyBits, unsigned int numOfThreads)
+{
+    size_t count = keys.size();
+    vector<uint64_t> sortedKeys(count);
+    vector<size_t> sortedOrder(count);
+
+    //LSD radix sort: each thread counts the digits of its range, then scatters
+    //them after the same digits of the previous threads, which keeps it stable
+    const size_t buckets = 1 << RADIX_BITS;
+    vector<size_t> histograms(numOfThreads * buckets);
+
+    for (int shift = 0; shift < keyBits; shift += RADIX_BITS) {
+
+        std::fill(histograms.begin(), histograms.end(), 0);
+        parallelRanges(count, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+            size_t *histogram = &histograms[t * buckets];
+            for (size_t i = begin; i < end; i++)
+                histogram[(keys[i] >> shift) & (buckets - 1)]++;
+        });
+
+        //Every key has the same digit, nothing to move
+        bool skip = false;
+        size_t offset = 0;
+        for (size_t digit = 0; digit < buckets; digit++) {
+            size_t digitCount = 0;
+            for (unsigned int t = 0; t < numOfThreads; t++) {
+                size_t threadCount = histograms[t * buckets + digit];
+                histograms[t * buckets + digit] = offset;
+                offset += threadCount;
+                digitCount += threadCount;
             }
+            skip = skip || (digitCount == count);
         }
+        if (skip)
+            continue;
 
-        if (isNeededNormalsEstimation) {
-            cout << "-> Estimating scene normals ..." << endl;
-            pcl::search::KdTree<pcl::PointXYZRGBNormal>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZRGBNormal> ());
-            pcl::NormalEstimationOMP<pcl::PointXYZRGBNormal, pcl::PointXYZRGBNormal> NEmop(0);
-            NEmop.setInputCloud(cloud->makeShared());
-            NEmop.setSearchMethod(tree);
-            NEmop.setKSearch(20);
-            NEmop.compute(*cloud);
+        parallelRanges(count, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+            size_t *position = &histograms[t * buckets];
+            for (size_t i = begin; i < end; i++) {
+                size_t target = position[(keys[i] >> shift) & (buckets - 1)]++;
+                sortedKeys[target] = keys[i];
+                sortedOrder[target] = order[i];
+            }
+        });
+
+        keys.swap(sortedKeys);
+        order.swap(sortedOrder);
+    }
+}
+
+
+void sortMorton(PointStore &points)
+{
+    cout << endl << "Sorting points in Morton order ..." << endl;
+
+    size_t numOfPoints = points.size();
+    if (numOfPoints < 2)
+        return;
+
+    unsigned int numOfThreads = max(thread::hardware_concurrency(), 1u);
+
+    //Same scale on every axis, so the curve cells are cubes
+    float minPoint[3], maxPoint[3];
+    boundingBox(points, minPoint, maxPoint);
+    float extent = max(max(maxPoint[0] - minPoint[0], maxPoint[1] - minPoint[1]), maxPoint[2] - minPoint[2]);
+    float scale = (extent > 0) ? ((1 << MORTON_BITS) - 1) / extent : 0.0f;
+
+    vector<uint64_t> keys(numOfPoints);
+    vector<size_t> order(numOfPoints);
+
+    parallelRanges(numOfPoints, numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; i++) {
+            keys[i] = expandBits((uint64_t) ((points.x[i] - minPoint[0]) * scale))
+                    | expandBits((uint64_t) ((points.y[i] - minPoint[1]) * scale)) << 1
+                    | expandBits((uint64_t) ((points.z[i] - minPoint[2]) * scale)) << 2;
+            order[i] = i;
         }
+    });
 
+    radixSort(keys, order, 3 * MORTON_BITS, numOfThreads);
 
+    PointStore sorted;
+    sorted.resize(numOfPoints);
+    if (!points.radius.empty())
+        sorted.radius.resize(numOfPoints);
+    parallelRanges(numOfPoints, numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; i++)
+            sorted.copyPoint(i, points, order[i]);
+    });
+    sorted.triangles = points.reorderTriangles(order);
+    swap(points, sorted);
+}
 
-        //Pushing data cloud to VAO structure
-        for (size_t i = 0; i < cloud->points.size (); ++i) {
-            cloud->points[i].x = cloud->points[i].x/maxDistance;
-            cloud->points[i].y = cloud->points[i].y/maxDistance;
-            cloud->points[i].z = cloud->points[i].z/maxDistance;
+
+//Packs the voxel coordinates of every point, MORTON_BITS bits per axis
+static void voxelKeys(PointStore &points, float origin[3], float voxelSize,
+                      vector<uint64_t> &keys, unsigned int numOfThreads)
+{
+    const uint64_t maxCoordinate = (1 << MORTON_BITS) - 1;
+
+    keys.resize(points.size());
+    parallelRanges(keys.size(), numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; i++) {
+            uint64_t x = min((uint64_t) ((points.x[i] - origin[0]) / voxelSize), maxCoordinate);
+            uint64_t y = min((uint64_t) ((points.y[i] - origin[1]) / voxelSize), maxCoordinate);
+            uint64_t z = min((uint64_t) ((points.z[i] - origin[2]) / voxelSize), maxCoordinate);
+            keys[i] = x | y << MORTON_BITS | z << (2 * MORTON_BITS);
+        }
+    });
+}
+
+
+//Distinct keys. Each thread hashes the keys of its own partition of the key space, so no set is shared
+static size_t countVoxels(vector<uint64_t> &keys, unsigned int numOfThreads)
+{
+    vector<size_t> counts(numOfThreads);
+
+    parallelRanges(numOfThreads, numOfThreads, [&] (size_t begin, size_t, unsigned int t) {
+        unordered_set<uint64_t> voxels;
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint64_t hash = keys[i] * 0x9e3779b97f4a7c15ULL;
+            if ((hash >> 32) % numOfThreads == t)
+                voxels.insert(keys[i]);
+        }
+        counts[t] = voxels.size();
+    });
+
+    size_t total = 0;
+    for (unsigned int t = 0; t < numOfThreads; t++)
+        total += counts[t];
+
+    return total;
+}
+
+
+void decimateCloud(PointStore &points, size_t targetPoints)
+{
+    size_t numOfPoints = points.size();
+    if (targetPoints == 0 || numOfPoints <= targetPoints)
+        return;
+
+    cout << endl << "Decimating to " << targetPoints << " points ..." << endl;
+
+    unsigned int numOfThreads = max(thread::hardware_concurrency(), 1u);
+
+    float minPoint[3], maxPoint[3];
+    boundingBox(points, minPoint, maxPoint);
+    float extent = max(max(maxPoint[0] - minPoint[0], maxPoint[1] - minPoint[1]), maxPoint[2] - minPoint[2]);
+
+    vector<uint64_t> keys;
+    float voxelSize = 0;
+
+    if (extent > 0) {
+        //Bisection in log scale between the finest grid the keys can hold and a single voxel
+        double low = log(extent / ((1 << MORTON_BITS) - 1));
+        double high = log(extent * 1.001);
+        voxelSize = exp(high);
+
+        for (int step = 0; step < VOXEL_SEARCH_STEPS; step++) {
+            double middle = (low + high) / 2;
+            voxelKeys(points, minPoint, exp(middle), keys, numOfThreads);
+            size_t voxels = countVoxels(keys, numOfThreads);
+
+            if (voxels > targetPoints)
+                low = middle;
+            else {
+                high = middle;
+                voxelSize = exp(middle);
+                if (voxels >= targetPoints * (1.0 - VOXEL_SEARCH_TOLERANCE))
+                    break;
+            }
         }
 
-        return VAO(cloud);
+        //Group the points of each voxel
+        voxelKeys(points, minPoint, voxelSize, keys, numOfThreads);
+    }
+    else {
+        //Every point at the same place, no grid to search: they collapse to a single surfel
+        keys.assign(numOfPoints, 0);
+    }
+
+    vector<size_t> order(numOfPoints);
+    for (size_t i = 0; i < numOfPoints; i++)
+        order[i] = i;
+    radixSort(keys, order, 3 * MORTON_BITS, numOfThreads);
+
+    vector<size_t> voxelStart;
+    for (size_t i = 0; i < numOfPoints; i++)
+        if (i == 0 || keys[i] != keys[i - 1])
+            voxelStart.push_back(i);
+    voxelStart.push_back(numOfPoints);
+
+    //One surfel per voxel
+    PointStore surfels;
+    surfels.resize(voxelStart.size() - 1);
+    parallelRanges(surfels.size(), numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        for (size_t v = begin; v < end; v++) {
+            double x = 0, y = 0, z = 0, r = 0, g = 0, b = 0;
+            Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+
+            for (size_t i = voxelStart[v]; i < voxelStart[v + 1]; i++) {
+                size_t point = order[i];
+                x += points.x[point]; y += points.y[point]; z += points.z[point];
+                r += points.r[point]; g += points.g[point]; b += points.b[point];
+                normal += Eigen::Vector3f(points.nx[point], points.ny[point], points.nz[point]);
+            }
+
+            size_t count = voxelStart[v + 1] - voxelStart[v];
+            surfels.copyPoint(v, points, order[voxelStart[v]]);
+            surfels.x[v] = x / count;
+            surfels.y[v] = y / count;
+            surfels.z[v] = z / count;
+            surfels.r[v] = r / count + 0.5;
+            surfels.g[v] = g / count + 0.5;
+            surfels.b[v] = b / count + 0.5;
+
+            //Opposite normals cancel out on thin surfaces, keep the first one then
+            if (normal.norm() > 1e-6f) {
+                normal.normalize();
+                surfels.nx[v] = normal.x();
+                surfels.ny[v] = normal.y();
+                surfels.nz[v] = normal.z();
+            }
+        }
+    });
+
+    swap(points, surfels);
+
+    cout << "-> Voxel size " << voxelSize << ", " << points.size() << " points." << endl;
+}
+
+
+size_t pointsInBudget(size_t bytes)
+{
+    return bytes / (sizeof(vaoGeometry) + sizeof(vaoAppearance));
+}
+
+
+bool hasValidNormals(PointStore &points)
+{
+    for (size_t i = 0; i < points.size(); i++) {
+        //This normal is not valid.
+        if (points.nx[i] == 0 && points.ny[i] == 0 && points.nz[i] == 0)
+            return false;
+    }
+
+    return true;
+}
+
+
+void estimateNormals(PointStore &points)
+{
+    cout << "-> Estimating scene normals ..." << endl;
+
+    size_t blocks = points.numOfSearchBlocks();
+    if (blocks > 1)
+        cout << "   " << points.size() << " points exceed the int indices of PCL, neighbours are searched within "
+             << blocks << " blocks of consecutive points." << endl;
+
+    for (size_t block = 0; block < blocks; block++) {
+        size_t first = block * POINTSTORE_SEARCH_BLOCK;
+        size_t count = min(POINTSTORE_SEARCH_BLOCK, points.size() - first);
+
+        pcl::PointCloud<pcl::PointXYZ>::Ptr positions (new pcl::PointCloud<pcl::PointXYZ>);
+        pcl::PointCloud<pcl::Normal> normals;
+        points.positionsToPCL(*positions, first, count);
+
+        pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ> ());
+        pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> NEmop(0);
+        NEmop.setInputCloud(positions);
+        NEmop.setSearchMethod(tree);
+        NEmop.setKSearch(20);
+        NEmop.compute(normals);
+
+        for (size_t i = 0; i < count; i++) {
+            points.nx[first + i] = normals.points[i].normal_x;
+            points.ny[first + i] = normals.points[i].normal_y;
+            points.nz[first + i] = normals.points[i].normal_z;
+        }
+    }
+}
+
+
+//Grid neighbour (column, row) of point i, if it is valid and on the same surface
+static bool gridNeighbour(PointStore &points, size_t i, long column, long row, glm::vec3 &neighbour)
+{
+    if (column < 0 || row < 0 || column >= (long) points.width || row >= (long) points.height)
+        return false;
+
+    size_t j = row * points.width + column;
+    if (!std::isfinite(points.x[j]) || !std::isfinite(points.y[j]) || !std::isfinite(points.z[j]))
+        return false;
+
+    neighbour = points.getPosition(j);
+    glm::vec3 position = points.getPosition(i);
+    return glm::length(neighbour - position) < GRID_MAX_JUMP * glm::length(position);
+}
+
+
+void estimateGridNormals(PointStore &points)
+{
+    if (!points.isOrganized())
+        return;
+
+    cout << "-> Estimating normals & radii on the " << points.width << "x" << points.height << " grid ..." << endl;
+
+    unsigned int numOfThreads = max(thread::hardware_concurrency(), 1u);
+    points.radius.assign(points.size(), 0.0f);
+
+    vector<double> radiusSum(numOfThreads, 0.0);
+    vector<size_t> radiusCount(numOfThreads, 0);
+
+    parallelRanges(points.height, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+        for (size_t row = begin; row < end; row++)
+            for (size_t column = 0; column < points.width; column++) {
+                size_t i = row * points.width + column;
+                glm::vec3 position = points.getPosition(i);
+                if (!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(position.z))
+                    continue;
+
+                //Normals stored in the file are kept, the grid only gives their radii
+                glm::vec3 stored = points.getNormal(i);
+                bool storedNormal = std::isfinite(stored.x) && std::isfinite(stored.y) && std::isfinite(stored.z)
+                                    && (stored.x != 0 || stored.y != 0 || stored.z != 0);
+
+                //Central differences, one-sided next to holes and borders
+                glm::vec3 left, right, up, down;
+                bool hasLeft = gridNeighbour(points, i, column - 1, row, left);
+                bool hasRight = gridNeighbour(points, i, column + 1, row, right);
+                bool hasUp = gridNeighbour(points, i, column, row - 1, up);
+                bool hasDown = gridNeighbour(points, i, column, row + 1, down);
+
+                //Facing the sensor at the origin when there are not enough neighbours
+                glm::vec3 normal = -position;
+                if ((hasLeft || hasRight) && (hasUp || hasDown)) {
+                    glm::vec3 horizontal = (hasRight ? right : position) - (hasLeft ? left : position);
+                    glm::vec3 vertical = (hasDown ? down : position) - (hasUp ? up : position);
+                    normal = glm::cross(horizontal, vertical);
+                    if (glm::dot(normal, position) > 0)
+                        normal = -normal;
+                }
+                if (glm::length(normal) > 0)
+                    normal = glm::normalize(normal);
+                if (!storedNormal) {
+                    points.nx[i] = normal.x;
+                    points.ny[i] = normal.y;
+                    points.nz[i] = normal.z;
+                }
+
+                //Radius reaching the farthest of the 8 neighbours, so the splats close the grid
+                float radius = 0;
+                glm::vec3 neighbour;
+                for (long dy = -1; dy <= 1; dy++)
+                    for (long dx = -1; dx <= 1; dx++)
+                        if ((dx != 0 || dy != 0) && gridNeighbour(points, i, column + dx, row + dy, neighbour))
+                            radius = max(radius, glm::length(neighbour - position));
+
+                points.radius[i] = radius;
+                if (radius > 0) {
+                    radiusSum[t] += radius;
+                    radiusCount[t]++;
+                }
+            }
+    });
+
+    //Isolated points take the average radius
+    double sum = 0;
+    size_t count = 0;
+    for (unsigned int t = 0; t < numOfThreads; t++) {
+        sum += radiusSum[t];
+        count += radiusCount[t];
+    }
+    float average = (count > 0) ? sum / count : 0.0f;
+    for (size_t i = 0; i < points.size(); i++)
+        if (points.radius[i] == 0)
+            points.radius[i] = average;
+}
+
+
+//Whether grid points i and j are both valid and on the same surface
+static bool gridEdge(PointStore &points, size_t i, size_t j)
+{
+    glm::vec3 neighbour;
+    return gridNeighbour(points, i, j % points.width, j / points.width, neighbour);
+}
+
+
+void buildGridMesh(PointStore &points)
+{
+    if (!points.isOrganized())
+        return;
+
+    unsigned int numOfThreads = max(thread::hardware_concurrency(), 1u);
+    vector<vector<uint32_t> > threadTriangles(numOfThreads);
+
+    //Two triangles per grid cell, each kept only if none of its edges crosses a depth discontinuity
+    parallelRanges(points.height - 1, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+        vector<uint32_t> &triangles = threadTriangles[t];
+        for (size_t row = begin; row < end; row++)
+            for (size_t column = 0; column + 1 < points.width; column++) {
+                size_t a = row * points.width + column;    //a-b
+                size_t b = a + 1;                          //| |
+                size_t c = a + points.width;               //c-d
+                size_t d = c + 1;
+
+                bool diagonal = gridEdge(points, b, c);
+                if (diagonal && gridEdge(points, a, b) && gridEdge(points, a, c)) {
+                    triangles.push_back(a);
+                    triangles.push_back(c);
+                    triangles.push_back(b);
+                }
+                if (diagonal && gridEdge(points, d, b) && gridEdge(points, d, c)) {
+                    triangles.push_back(b);
+                    triangles.push_back(c);
+                    triangles.push_back(d);
+                }
+            }
+    });
+
+    points.triangles.clear();
+    for (unsigned int t = 0; t < numOfThreads; t++)
+        points.triangles.insert(points.triangles.end(), threadTriangles[t].begin(), threadTriangles[t].end());
+
+    cout << "-> " << points.triangles.size() / 3 << " triangles on the " << points.width << "x" << points.height << " grid." << endl;
+}
+
+
+void scaleCloud(PointStore &points, float maxDistance)
+{
+    for (size_t i = 0; i < points.size (); ++i) {
+        points.x[i] = points.x[i]/maxDistance;
+        points.y[i] = points.y[i]/maxDistance;
+        points.z[i] = points.z[i]/maxDistance;
+    }
+
+    for (size_t i = 0; i < points.radius.size(); ++i)
+        points.radius[i] = points.radius[i]/maxDistance;
+}
+
+
+//Return VAO with .numOfTrianges = 0 && numOfVertices = 0 if error
+VAO loadCloud(string pathFile, size_t targetPoints)
+{
+    PointStore points;
+
+    VAO vao;
+
+    if (!readCloud(pathFile, points))
+        return vao;
+
+    //Organized clouds get their normals, radii & mesh from the grid, before the NaN removal breaks it
+    if (points.isOrganized()) {
+        estimateGridNormals(points);
+        buildGridMesh(points);
+    }
+
+    removeNaNPoints(points);
+
+    if (!points.empty()) {
+
+        float maxDistance = centerCloud(points);
+
+        decimateCloud(points, targetPoints);
+
+        //Spatial order before any neighbour search and before the VBO split
+        sortMorton(points);
+
+        //Normals & radii are computed when a shader reads them, see VAO::requestAttributes
+        cout << endl << "Analizing scene normals ..." << endl;
+
+        if (!hasValidNormals(points))
+            cout << "-> Failed to find valid normals on the pointCloud, they will be estimated on demand." << endl;
+
+        //Pushing data cloud to VAO structure
+        scaleCloud(points, maxDistance);
+
+        return VAO(std::move(points));
 
     }
     else
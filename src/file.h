@@ -29,6 +29,7 @@
 #define __CUBE__file__
 
 #include <iostream>
+#include <functional>
 #include <GL/glew.h>
 
 #include "vao.h"
@@ -45,11 +46,106 @@ char* loadFile(string fname, GLint &fSize);
 
 
 /**
- Returns a buffer with file data
- @param[in] fname path to file
- @param[out] fSize file size
- @returns memblock
+ Returns a VAO with the cloud stored in a file, running every preprocessing
+ stage below. The VAO is not valid if the file can not be used.
+ @param[in] pathFile path to a .pcd or .ply file
+ @param[in] targetPoints clouds with more points are decimated, 0 keeps every point
+ @returns VAO
+ */
+VAO loadCloud(string pathFile, size_t targetPoints = 0);
+
+/**
+ Returns how many points fit in a GPU memory budget
+ @param[in] bytes budget
+ @returns points
+ */
+size_t pointsInBudget(size_t bytes);
+
+/**
+ Splits [0, count) into one range per thread and runs f(begin, end, thread) on
+ each, returning once every thread is done
+ @param[in] count
+ @param[in] numOfThreads
+ @param[in] f
+ */
+void parallelRanges(size_t count, unsigned int numOfThreads, function<void(size_t, size_t, unsigned int)> f);
+
+
+//Preprocessing stages of loadCloud, exposed to time them separately
+
+/**
+ Parses a .pcd or .ply file
+ @param[in] pathFile path to file
+ @param[out] points parsed points
+ @returns false if the file can not be read
+ */
+bool readCloud(string pathFile, PointStore &points);
+
+/**
+ Removes the points with NaN coordinates
+ @param[in,out] points
+ */
+void removeNaNPoints(PointStore &points);
+
+/**
+ Moves the centroid of the cloud to the origin
+ @param[in,out] points
+ @returns largest coordinate after centering, used to scale the cloud
+ */
+float centerCloud(PointStore &points);
+
+/**
+ Merges the points of each voxel of a grid into one surfel with the average
+ position, color and normal. The voxel size is searched so that the result has
+ at most targetPoints points, as close to it as possible.
+ @param[in,out] points
+ @param[in] targetPoints
+ */
+void decimateCloud(PointStore &points, size_t targetPoints);
+
+/**
+ Reorders the points along a Morton (Z-order) curve with a parallel radix sort,
+ so points close in the cloud are close in memory and in the VBO chunks
+ @param[in,out] points
+ */
+void sortMorton(PointStore &points);
+
+/**
+ @param[in] points
+ @returns false if any point has a null normal
+ */
+bool hasValidNormals(PointStore &points);
+
+/**
+ Estimates the normal of every point from its 20 nearest neighbours
+ @param[in,out] points
+ */
+void estimateNormals(PointStore &points);
+
+/**
+ Estimates the normals and radii of an organized cloud from its grid
+ neighbours, in linear time and without a kd-tree. Must run before the NaN
+ removal, which breaks the grid. Neighbours across a depth discontinuity are
+ ignored, and normals face the sensor at the origin. Valid normals already
+ stored in the cloud are kept, only their radii are estimated.
+ @param[in,out] points
+ */
+void estimateGridNormals(PointStore &points);
+
+/**
+ Triangulates the grid of an organized cloud into its range image mesh, two
+ triangles per cell, dropping those with an edge across a depth discontinuity
+ or a NaN corner. Must run before the NaN removal, like estimateGridNormals;
+ later reorders keep the triangles, decimation discards them.
+ @param[in,out] points
+ */
+void buildGridMesh(PointStore &points);
+
+/**
+ Scales the cloud to fit in [-1, 1], radii included
+ @param[in,out] points
+ @param[in] maxDistance value returned by centerCloud
  */
-VAO loadCloud(string pathFile);
+void scaleCloud(PointStore &points, float maxDistance);
 
 #endif
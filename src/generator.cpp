@@ -0,0 +1,285 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "generator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <thread>
+
+#include "file.h"
+
+#define TERRAIN_HEIGHT 0.15f
+#define TERRAIN_NOISE 0.01f
+
+static const char *shapeNames[] = {"sphere", "plane", "terrain", "mixture"};
+
+
+/**
+ @brief Reads "shape:points[:seed]", or just a number of points for a sphere
+ @param description e.g. terrain:10000000:7
+ @param spec output
+ @returns false if the description is not valid
+ */
+bool Generator::parse(string description, generatorSpec &spec)
+{
+    spec.shape = SPHERE;
+    spec.seed = 0;
+
+    size_t colon = description.find(':');
+    string count = description;
+    if (colon != string::npos) {
+        string name = description.substr(0, colon);
+        count = description.substr(colon + 1);
+
+        bool found = false;
+        for (int i = 0; i < 4; i++)
+            if (name == shapeNames[i]) {
+                spec.shape = (generatorShape) i;
+                found = true;
+            }
+        if (!found)
+            return false;
+
+        colon = count.find(':');
+        if (colon != string::npos) {
+            spec.seed = strtoull(count.substr(colon + 1).c_str(), NULL, 10);
+            count = count.substr(0, colon);
+        }
+    }
+
+    spec.numOfPoints = strtoull(count.c_str(), NULL, 10);
+    return spec.numOfPoints > 0;
+}
+
+
+string Generator::getShapeName(generatorShape shape)
+{
+    return shapeNames[shape];
+}
+
+
+string Generator::getName(const generatorSpec &spec)
+{
+    return getShapeName(spec.shape) + " " + to_string(spec.numOfPoints) + " (seed " + to_string(spec.seed) + ")";
+}
+
+
+/**
+ @brief Counter-based random number: splitmix64 hashes of the seed, the
+ counter and the draw, with no state shared between calls
+ @param seed
+ @param counter usually the index of the point
+ @param draw index of the value drawn for that point
+ @returns uniform value in [0, 1)
+ */
+float Generator::random(uint64_t seed, uint64_t counter, unsigned int draw)
+{
+    uint64_t v = seed * 0xd1342543de82ef95ULL + counter * 8 + draw;
+    v += 0x9e3779b97f4a7c15ULL;
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebULL;
+    v = v ^ (v >> 31);
+
+    return (v >> 40) * (1.0f / (1 << 24));
+}
+
+
+//Uniform point on a sphere
+static void spherePoint(float u, float v, glm::vec3 center, float radius, glm::vec3 &position, glm::vec3 &normal)
+{
+    float z = 2.0f * u - 1.0f;
+    float phi = 2.0f * M_PI * v;
+    float ring = sqrt(max(0.0f, 1.0f - z * z));
+
+    normal = glm::vec3(ring * cos(phi), ring * sin(phi), z);
+    position = center + radius * normal;
+}
+
+
+/**
+ @brief Samples point index of the cloud
+ @returns radius of the point: the one covering GENERATOR_NEIGHBOURS neighbours
+ at the density of the surface it lies on
+ */
+float Generator::samplePoint(const generatorSpec &spec, size_t index, glm::vec3 &position, glm::vec3 &normal, glm::vec3 &color)
+{
+    float u = random(spec.seed, index, 0);
+    float v = random(spec.seed, index, 1);
+    float area = 4.0f;          //of the surface the point lies on
+    float share = 1.0f;         //of the points on that surface
+
+    switch (spec.shape) {
+        case SPHERE:
+            spherePoint(u, v, glm::vec3(0.0f), 1.0f, position, normal);
+            color = (position.z >= 0) ? glm::vec3(0, 0, 1) : glm::vec3(1, 0, 0);
+            area = 4.0f * M_PI;
+            break;
+
+        case PLANE: {
+            position = glm::vec3(2.0f * u - 1.0f, 0.0f, 2.0f * v - 1.0f);
+            normal = glm::vec3(0, 1, 0);
+            int checker = (int) ((position.x + 1.0f) * 4.0f) + (int) ((position.z + 1.0f) * 4.0f);
+            color = glm::vec3((checker % 2) ? 0.8f : 0.3f);
+            break;
+        }
+
+        case TERRAIN: {
+            float x = 2.0f * u - 1.0f;
+            float z = 2.0f * v - 1.0f;
+            float y = TERRAIN_HEIGHT * (sin(3*x) * cos(2*z) + 0.5f * sin(7*x + 1) * sin(5*z))
+                    + TERRAIN_NOISE * (random(spec.seed, index, 2) - 0.5f);
+            float dx = TERRAIN_HEIGHT * (3 * cos(3*x) * cos(2*z) + 3.5f * cos(7*x + 1) * sin(5*z));
+            float dz = TERRAIN_HEIGHT * (-2 * sin(3*x) * sin(2*z) + 2.5f * sin(7*x + 1) * cos(5*z));
+
+            position = glm::vec3(x, y, z);
+            normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+
+            float height = (y / TERRAIN_HEIGHT + 1.5f) / 3.0f;
+            color = (height > 0.8f) ? glm::vec3(0.95f) : glm::mix(glm::vec3(0.2f, 0.5f, 0.2f), glm::vec3(0.5f, 0.4f, 0.3f), height);
+            break;                  //area of the projected square, the slopes are ignored
+        }
+
+        case MIXTURE: {
+            float component = random(spec.seed, index, 3);
+            if (component < 0.5f) {
+                spherePoint(u, v, glm::vec3(-0.4f, 0.1f, 0.0f), 0.35f, position, normal);
+                area = 4.0f * M_PI * 0.35f * 0.35f;
+                share = 0.5f;
+            }
+            else if (component < 0.7f) {
+                spherePoint(u, v, glm::vec3(0.5f, -0.1f, 0.3f), 0.15f, position, normal);
+                area = 4.0f * M_PI * 0.15f * 0.15f;
+                share = 0.2f;
+            }
+            else {
+                position = glm::vec3(2.0f * u - 1.0f, -0.6f, 2.0f * v - 1.0f);
+                normal = glm::vec3(0, 1, 0);
+                share = 0.3f;
+            }
+            color = glm::vec3(0.5f) + 0.5f * normal;
+            break;
+        }
+    }
+
+    return sqrt(GENERATOR_NEIGHBOURS * area / (M_PI * share * spec.numOfPoints));
+}
+
+
+/**
+ @brief Fills points with the range [first, first + count) of a cloud, radii included
+ @param spec cloud
+ @param first index of the first point
+ @param count points generated
+ @param points output, resized to count
+ @param numOfThreads threads used, 0 for every core
+ */
+void Generator::generate(const generatorSpec &spec, size_t first, size_t count, PointStore &points, unsigned int numOfThreads)
+{
+    if (numOfThreads == 0)
+        numOfThreads = max(thread::hardware_concurrency(), 1u);
+
+    points.resize(count);
+    points.radius.resize(count);
+
+    parallelRanges(count, numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        glm::vec3 position, normal, color;
+        for (size_t i = begin; i < end; i++) {
+            points.radius[i] = samplePoint(spec, first + i, position, normal, color);
+            points.setPoint(i, position, normal, color);
+        }
+    });
+}
+
+
+/**
+ @returns VAO with the whole cloud, ready to be pushed to the GPU
+ */
+VAO Generator::generateModel(const generatorSpec &spec)
+{
+    cout << endl << "Generating " << getName(spec) << " ..." << endl;
+
+    PointStore points;
+    generate(spec, 0, spec.numOfPoints, points);
+
+    return VAO(std::move(points));
+}
+
+
+/**
+ @brief Writes the cloud as a binary PLY, one block of GENERATOR_BLOCK points at
+ a time, so clouds far larger than the host memory can be written
+ @param spec cloud
+ @param path output file
+ @param numOfThreads threads used, 0 for every core
+ @returns false if the file can not be written
+ */
+bool Generator::writePLY(const generatorSpec &spec, string path, unsigned int numOfThreads)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        cout << "Can not write " << path << endl;
+        return false;
+    }
+
+    uint16_t one = 1;
+    bool littleEndian = *((uint8_t*) &one) == 1;
+
+    fprintf(file, "ply\nformat %s 1.0\nelement vertex %llu\n", littleEndian ? "binary_little_endian" : "binary_big_endian",
+            (unsigned long long) spec.numOfPoints);
+    fprintf(file, "property float x\nproperty float y\nproperty float z\n");
+    fprintf(file, "property float nx\nproperty float ny\nproperty float nz\n");
+    fprintf(file, "property uchar red\nproperty uchar green\nproperty uchar blue\nend_header\n");
+
+    const size_t vertexSize = 6 * sizeof(float) + 3;
+    PointStore points;
+    vector<char> buffer;
+    bool ok = true;
+
+    for (size_t first = 0; first < spec.numOfPoints && ok; first += GENERATOR_BLOCK) {
+        size_t count = min((size_t) GENERATOR_BLOCK, spec.numOfPoints - first);
+        generate(spec, first, count, points, numOfThreads);
+
+        buffer.resize(count * vertexSize);
+        for (size_t i = 0; i < count; i++) {
+            float attributes[] = {points.x[i], points.y[i], points.z[i], points.nx[i], points.ny[i], points.nz[i]};
+            uint8_t color[] = {points.r[i], points.g[i], points.b[i]};
+            memcpy(&buffer[i * vertexSize], attributes, sizeof(attributes));
+            memcpy(&buffer[i * vertexSize + sizeof(attributes)], color, sizeof(color));
+        }
+
+        ok = fwrite(&buffer[0], 1, buffer.size(), file) == buffer.size();
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+        cout << "Failed writing " << path << endl;
+
+    return ok;
+}
@@ -0,0 +1,86 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__generator__
+#define __CUBE__generator__
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+
+#include "pointstore.h"
+#include "vao.h"
+
+#define GENERATOR_BLOCK (1024*1024)   //points generated and written at once when streaming to disk
+#define GENERATOR_NEIGHBOURS 12       //radius covers this many neighbours, as VAO::computeRadius
+
+namespace generator
+{
+    enum generatorShape {
+        SPHERE      = 0,    //unit sphere, blue & red hemispheres
+        PLANE       = 1,    //2x2 square
+        TERRAIN     = 2,    //noisy height field over a 2x2 square
+        MIXTURE     = 3     //dense spheres over a sparse plane
+    };
+}
+
+using namespace std;
+using namespace generator;
+
+struct generatorSpec {
+    generatorShape shape;
+    size_t numOfPoints;
+    uint64_t seed;
+};
+
+/**
+ @brief Synthetic surfel clouds of any size for stress tests. Every random
+ value is a hash of the seed and the point index, so a cloud is the same
+ whatever the number of threads filling it, and any range of it can be
+ generated on its own. Radii follow from the sampling density, so no
+ neighbour search is needed.
+ */
+class Generator {
+
+private:
+    Generator();
+
+    static float samplePoint(const generatorSpec &spec, size_t index, glm::vec3 &position, glm::vec3 &normal, glm::vec3 &color);
+
+public:
+    static bool parse(string description, generatorSpec &spec);
+    static string getName(const generatorSpec &spec);
+    static string getShapeName(generatorShape shape);
+    static float random(uint64_t seed, uint64_t counter, unsigned int draw);
+
+    static void generate(const generatorSpec &spec, size_t first, size_t count, PointStore &points, unsigned int numOfThreads = 0);
+    static VAO generateModel(const generatorSpec &spec);
+    static bool writePLY(const generatorSpec &spec, string path, unsigned int numOfThreads = 0);
+
+};
+
+#endif
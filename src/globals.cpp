@@ -32,6 +32,8 @@
 #include "cameralight.h"
 #include "staticlight.h"
 #include "camera.h"
+#include "splatcache.h"
+#include "scene.h"
 
 using namespace shader;
 
@@ -45,19 +47,31 @@ Camera* Globals::mainCamera;
 double Globals::lastMouseX, Globals::lastMouseY;
 bool Globals::leftBtnPress;
 Shader* Globals::fxaaFilter;
+Shader* Globals::rangeMeshShader;
+Shader* Globals::edlShader;
+Shader* Globals::pullShader;
+Shader* Globals::pushShader;
 GLuint Globals::textureID;
 bool Globals::firstTime;
 unsigned int Globals::actualShader;
 unsigned int Globals::actualMultipass;
 vector<Shader> Globals::listOfShaders;
+SplatCache* Globals::splatCache;
 bool Globals::MultipassEnabled;
 bool Globals::FXAA;
 bool Globals::colorEnabled;
 bool Globals::automaticRadiusEnabled;
+bool Globals::tightBoundsEnabled;
+bool Globals::splatCacheEnabled;
+bool Globals::rangeMeshEnabled;
+bool Globals::edlEnabled;
+bool Globals::pullPushEnabled;
 bool Globals::debug;
 vector<VAO> Globals::models;
 unsigned int Globals::actualVAO;
 VAO* Globals::displayVAO;
+size_t Globals::pointBudget;
+Scene* Globals::scene;
 
 void Globals::init() {
     
@@ -132,6 +146,22 @@ void Globals::init() {
                             "0_fxaa/vertexShader.glsl",
                             "0_fxaa/fragmentShader.glsl",
                             SINGLEPASS);
+    rangeMeshShader = new Shader("Range Image Mesh",
+                                 "5_range-image-mesh/vertexShader.glsl",
+                                 "5_range-image-mesh/fragmentShader.glsl",
+                                 SINGLEPASS);
+    edlShader = new Shader("Eye-Dome Lighting",
+                           "0_eye-dome-lighting/vertexShader.glsl",
+                           "0_eye-dome-lighting/fragmentShader.glsl",
+                           SINGLEPASS);
+    pullShader = new Shader("Pull",
+                            "0_pull-push/vertexShader.glsl",
+                            "0_pull-push/pullFragmentShader.glsl",
+                            SINGLEPASS);
+    pushShader = new Shader("Push",
+                            "0_pull-push/vertexShader.glsl",
+                            "0_pull-push/pushFragmentShader.glsl",
+                            SINGLEPASS);
     textureID = 0;
     firstTime = true;
     actualShader = 0;
@@ -141,10 +171,12 @@ void Globals::init() {
                                     "1_fixed-sized-points/vertexShader.glsl",
                                     "1_fixed-sized-points/fragmentShader.glsl",
                                     SINGLEPASS) );
+    listOfShaders.back().setSurfaceAttributes(false);   //normals only lit with C
     listOfShaders.push_back(Shader("Square Size - Corrected by Depth",
                                    "2_square-Sized-corrected/vertexShader.glsl",
                                    "2_square-Sized-corrected/fragmentShader.glsl",
                                    SINGLEPASS));
+    listOfShaders.back().setSurfaceAttributes(false);   //normals only lit with C, radii only with A
     listOfShaders.push_back(Shader("Affinely Projected Point Sprites" ,
                                    "3_affinely-projected-point-sprites/vertexShader.glsl",
                                    "3_affinely-projected-point-sprites/fragmentShader.glsl",
@@ -191,16 +223,67 @@ void Globals::init() {
                               "4_perspective-corrected/pass_3_normalization/deferredFragmentShader.glsl",
                               NORMALIZATION));
     
+    //Single splat pass, depth-aware weighted blending over the nearest depth
+    //of each tile, reprojected from the previous frame
+    vector<Shader> weightedPhong;
+    weightedPhong.push_back(Shader("Weighted Phong",
+                                   "4_perspective-corrected/pass_2_blending/tileReprojectionVertexShader.glsl",
+                                   "4_perspective-corrected/pass_2_blending/tileReprojectionFragmentShader.glsl",
+                                   TILE_REPROJECTION));
+    weightedPhong.push_back(Shader("Weighted Phong",
+                                   "4_perspective-corrected/pass_2_blending/phongVertexShader.glsl",
+                                   "4_perspective-corrected/pass_2_blending/weightedPhongFragmentShader.glsl",
+                                   WEIGHTED_BLENDING));
+    weightedPhong.push_back(Shader("Weighted Phong",
+                                   "4_perspective-corrected/pass_3_normalization/vertexShader.glsl",
+                                   "4_perspective-corrected/pass_2_blending/tileDepthFragmentShader.glsl",
+                                   TILE_DEPTH));
+    weightedPhong.push_back(Shader("Weighted Phong",
+                                   "4_perspective-corrected/pass_3_normalization/vertexShader.glsl",
+                                   "4_perspective-corrected/pass_3_normalization/fragmentShader.glsl",
+                                   NORMALIZATION));
+    
+    //Tight splat bounds, emitted by a geometry shader instead of point sprites
+    gouraud[0].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                   "4_perspective-corrected/tight_bounds/visibilityGeometryShader.glsl");
+    gouraud[1].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                   "4_perspective-corrected/tight_bounds/geometryShader.glsl");
+    phong[0].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                 "4_perspective-corrected/tight_bounds/visibilityGeometryShader.glsl");
+    phong[1].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                 "4_perspective-corrected/tight_bounds/geometryShader.glsl");
+    deferred[0].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                    "4_perspective-corrected/tight_bounds/visibilityGeometryShader.glsl");
+    deferred[1].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                    "4_perspective-corrected/tight_bounds/geometryShader.glsl");
+    weightedPhong[1].setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                         "4_perspective-corrected/tight_bounds/geometryShader.glsl");
+    
+    //Splat passes able to read the splat cache instead of the model
+    gouraud[0].setCachedInput(true);
+    gouraud[1].setCachedInput(true);
+    phong[0].setCachedInput(true);
+    phong[1].setCachedInput(true);
+    deferred[0].setCachedInput(true);
+    deferred[1].setCachedInput(true);
+    weightedPhong[1].setCachedInput(true);
+    
     vector<vector <Shader> > vec;
     vec.push_back(gouraud);
     vec.push_back(phong);
     vec.push_back(deferred);
+    vec.push_back(weightedPhong);
     
     listOfShaders.push_back(Shader("Perspective Correct Rasterization",
                                    "4_perspective-corrected/vertexShader.glsl",
                                    "4_perspective-corrected/fragmentShader.glsl",
                                    SINGLEPASS,
                                    vec) );
+    listOfShaders.back().setBoundingGeometry("4_perspective-corrected/tight_bounds/vertexShader.glsl",
+                                             "4_perspective-corrected/tight_bounds/geometryShader.glsl");
+    listOfShaders.back().setCachedInput(true);
+    
+    splatCache = new SplatCache();
     
     textureID = 0;
     firstTime = true;
@@ -210,11 +293,18 @@ void Globals::init() {
     FXAA = false;
     colorEnabled = false;
     automaticRadiusEnabled = false;
+    tightBoundsEnabled = false;
+    splatCacheEnabled = false;
+    rangeMeshEnabled = false;
+    edlEnabled = false;
+    pullPushEnabled = false;
     debug = false;
     
     //Models
     actualVAO = 0;
     displayVAO = NULL;
+    pointBudget = 0;
+    scene = NULL;
     
 };
 
@@ -44,6 +44,8 @@ class Shader;
 class Light;
 class OrbitalLight;
 class Camera;
+class SplatCache;
+class Scene;
 
 class Globals {
 private:
@@ -69,23 +71,35 @@ public:
 
     //Shaders
     static Shader* fxaaFilter;
+    static Shader* rangeMeshShader; //lit triangles of the range image mesh of organized clouds
+    static Shader* edlShader;       //eye-dome lighting over the depth of the shaders without normals
+    static Shader* pullShader;      //pull-push hole filling, one level coarser
+    static Shader* pushShader;      //pull-push hole filling, one level finer
     static GLuint textureID;    //texture for renderToTexture in fxaa
     static bool firstTime;      //textureID initialized?
     static unsigned int actualShader;
     static unsigned int actualMultipass;
     static vector<Shader> listOfShaders;
+    static SplatCache* splatCache;  //camera space splats shared by the perspective correct passes
 
     //Flags
     static bool MultipassEnabled;
     static bool FXAA;
     static bool colorEnabled;
     static bool automaticRadiusEnabled;
+    static bool tightBoundsEnabled;
+    static bool splatCacheEnabled;
+    static bool rangeMeshEnabled;   //draw organized clouds as their range image mesh instead of splats
+    static bool edlEnabled;
+    static bool pullPushEnabled;
     static bool debug;
 
     //Models
     static vector<VAO> models;
     static unsigned int actualVAO;
     static VAO* displayVAO;     //Pointer to the VAO to be rendered in display func
+    static size_t pointBudget;  //clouds with more points are decimated on load, 0 keeps every point
+    static Scene* scene;        //instanced models of --scene, NULL otherwise
 
     static void init();
 
@@ -0,0 +1,439 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+//Headless CUBE: renders a cloud from a list of viewpoints without a window or
+//a display server, on an EGL context (e.g. Mesa llvmpipe) or with the CPU splat
+//rasterizer, and writes PPM images.
+//
+//USAGE: cube_headless [--cloud file] [--shader n] [--shading n] [--lights n] [--fxaa]
+//                     [--edl] [--pull-push] [--range-mesh]
+//                     [--size WIDTHxHEIGHT] [--views n | --viewpoints file] [--output prefix]
+//                     [--points n | --memory MB] [--generate [shape:]points[:seed] | --mesh file] [--scene file]
+//                     [--software [--threads n]]
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GL/glew.h>
+#ifdef CUBE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "globals.h"
+#include "file.h"
+#include "vao.h"
+#include "shader.h"
+#include "camera.h"
+#include "renderer.h"
+#include "softrenderer.h"
+#include "scene.h"
+#include "generator.h"
+#include "meshsampler.h"
+
+#define DEFAULT_WIDTH 640
+#define DEFAULT_HEIGHT 480
+#define DEFAULT_VIEWS 8
+
+using namespace std;
+
+
+struct viewpoint {
+    float yaw;          //degrees around the up vector
+    float pitch;        //degrees around the right vector
+    float distance;     //to the origin, 0 keeps the initial one
+};
+
+
+#ifdef CUBE_EGL
+/**
+ @brief Creates an OpenGL 4.1 core context on the default EGL display or, when
+ there is none, on Mesa's surfaceless platform, and makes it current
+ @returns false if no context can be created
+ */
+bool createContext()
+{
+    EGLint major, minor;
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay != NULL)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            cout << "No EGL display available." << endl;
+            return false;
+        }
+    }
+
+    cout << "EGL version: " << major << "." << minor << endl;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        cout << "EGL does not support desktop OpenGL." << endl;
+        return false;
+    }
+
+    //Pbuffer capable configs first, surfaceless platforms have none
+    EGLint surfaceTypes[2] = {EGL_PBUFFER_BIT, 0};
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    for (int i = 0; i < 2 && numConfigs == 0; i++) {
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, surfaceTypes[i],
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_NONE
+        };
+        eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
+    }
+
+    if (numConfigs == 0) {
+        cout << "No EGL config supports OpenGL." << endl;
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        cout << "Can not create an OpenGL 4.1 core context." << endl;
+        return false;
+    }
+
+    //Everything is rendered to the offscreen framebuffer, the 1x1 pbuffer only
+    //makes the context current where surfaceless contexts are not supported
+    if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        return true;
+
+    const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+
+    if (surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context)) {
+        cout << "Can not make the EGL context current." << endl;
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+
+/**
+ @brief Writes a binary PPM image
+ @param path output file
+ @param width, height size of the image
+ @param pixels RGB bytes, bottom row first as read from OpenGL
+ @returns false if the file can not be written
+ */
+bool writePPM(string path, int width, int height, vector<unsigned char> &pixels)
+{
+    ofstream file(path.c_str(), ios::out | ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int row = height - 1; row >= 0; row--)
+        file.write((const char*) &pixels[row * width * 3], width * 3);
+
+    return file.good();
+}
+
+
+/**
+ @brief Reads one viewpoint per line: yaw pitch [distance]
+ @param path input file
+ @param viewpoints read viewpoints
+ @returns false if the file can not be opened
+ */
+bool readViewpoints(string path, vector<viewpoint> &viewpoints)
+{
+    ifstream file(path.c_str());
+    if (!file.is_open())
+        return false;
+
+    string line;
+    while (getline(file, line)) {
+        viewpoint view = {0.0f, 0.0f, 0.0f};
+        if (sscanf(line.c_str(), "%f %f %f", &view.yaw, &view.pitch, &view.distance) >= 2)
+            viewpoints.push_back(view);
+    }
+
+    return true;
+}
+
+
+/**
+ @brief Passes which read the previous frame need one frame of warm-up per view
+ @returns true if the selected shading reprojects the tile depths
+ */
+bool needsWarmUp()
+{
+    if (!Globals::MultipassEnabled)
+        return false;
+
+    Shader &shader = Globals::listOfShaders[Globals::actualShader % Globals::listOfShaders.size()];
+    vector<Shader> &passes = shader.getMultiPass(Globals::actualMultipass % shader.getMultiPass().size());
+
+    for (unsigned int i = 0; i < passes.size(); i++)
+        if (passes[i].getMode() == TILE_REPROJECTION)
+            return true;
+
+    return false;
+}
+
+
+void setView(viewpoint &view, int width, int height)
+{
+    Camera::activeCamera->reset();
+    if (view.distance > 0)
+        Camera::activeCamera->setDistance(view.distance);
+    Camera::activeCamera->rotate(view.yaw, view.pitch);
+    Camera::activeCamera->updateView(width, height);
+
+    Renderer::updateLightPosition();
+}
+
+
+void writeView(string outputPrefix, int index, int width, int height, vector<unsigned char> &pixels)
+{
+    char suffix[16];
+    sprintf(suffix, "_%04d.ppm", index);
+    if (!writePPM(outputPrefix + suffix, width, height, pixels))
+        cout << "Can not write " << outputPrefix + suffix << endl;
+}
+
+
+/**
+ @brief Renders every view with the CPU rasterizer. It implements the Gouraud
+ (shading 0) and Phong weights of the perspective-corrected shader; the rest of
+ the shadings are rendered as Phong, without FXAA.
+ @returns exit status
+ */
+int renderSoftware(vector<viewpoint> &viewpoints, int width, int height, unsigned int threads, int shading, string outputPrefix)
+{
+    SoftRenderer renderer(threads);
+    renderer.setPhong(shading != 0);
+    renderer.setModel(Globals::displayVAO);
+    renderer.resize(width, height);
+
+    cout << "Software rendering on " << renderer.getNumOfThreads() << " threads." << endl;
+
+    vector<unsigned char> pixels;
+    for (unsigned int i = 0; i < viewpoints.size(); i++) {
+        setView(viewpoints[i], width, height);
+        renderer.render(pixels);
+        writeView(outputPrefix, i, width, height, pixels);
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    Globals::init();
+
+    string cloudPath;
+    string viewpointsPath;
+    string scenePath;
+    string generatedCloud;
+    string meshPath;
+    string outputPrefix = "view";
+    int width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
+    int views = DEFAULT_VIEWS;
+    int shading = -1;
+    bool software = false;
+    unsigned int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--cloud" && i + 1 < argc)
+            cloudPath = argv[++i];
+        else if (arg == "--shader" && i + 1 < argc)
+            Globals::actualShader = atoi(argv[++i]);
+        else if (arg == "--shading" && i + 1 < argc)
+            shading = atoi(argv[++i]);
+        else if (arg == "--lights" && i + 1 < argc)
+            Globals::sceneLightsArrIndex = atoi(argv[++i]);
+        else if (arg == "--fxaa")
+            Globals::FXAA = true;
+        else if (arg == "--edl")
+            Globals::edlEnabled = true;
+        else if (arg == "--pull-push")
+            Globals::pullPushEnabled = true;
+        else if (arg == "--range-mesh")
+            Globals::rangeMeshEnabled = true;
+        else if (arg == "--size" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+                cout << "Wrong size " << argv[i] << ", expected WIDTHxHEIGHT" << endl;
+        }
+        else if (arg == "--views" && i + 1 < argc)
+            views = atoi(argv[++i]);
+        else if (arg == "--viewpoints" && i + 1 < argc)
+            viewpointsPath = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+            outputPrefix = argv[++i];
+        else if (arg == "--points" && i + 1 < argc)
+            Globals::pointBudget = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--memory" && i + 1 < argc)
+            Globals::pointBudget = pointsInBudget(strtoull(argv[++i], NULL, 10) * 1024 * 1024);
+        else if (arg == "--generate" && i + 1 < argc)
+            generatedCloud = argv[++i];
+        else if (arg == "--mesh" && i + 1 < argc)
+            meshPath = argv[++i];
+        else if (arg == "--scene" && i + 1 < argc)
+            scenePath = argv[++i];
+        else if (arg == "--software")
+            software = true;
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else
+            cout << "Unknown argument " << argv[i] << endl;
+    }
+
+    //Shading -1 is the single pass shader, the rest its multipass variants
+    Globals::actualShader = Globals::actualShader % Globals::listOfShaders.size();
+    if (shading >= 0 && !Globals::listOfShaders[Globals::actualShader].getMultiPass().empty()) {
+        Globals::MultipassEnabled = true;
+        Globals::actualMultipass = shading;
+    }
+
+    vector<viewpoint> viewpoints;
+    if (!viewpointsPath.empty()) {
+        if (!readViewpoints(viewpointsPath, viewpoints)) {
+            cout << "Can not open " << viewpointsPath << endl;
+            return 1;
+        }
+    }
+    else
+        for (int i = 0; i < views; i++) {
+            viewpoint view = {360.0f * i / views, 0.0f, 0.0f};
+            viewpoints.push_back(view);
+        }
+
+    VAO model;
+    generatorSpec spec;
+    if (!generatedCloud.empty()) {
+        if (!Generator::parse(generatedCloud, spec)) {
+            cout << "Wrong synthetic cloud " << generatedCloud << ", expected [shape:]points[:seed]" << endl;
+            return 1;
+        }
+        model = Generator::generateModel(spec);
+    }
+    else if (!meshPath.empty()) {
+        model = MeshSampler::loadMesh(meshPath, Globals::pointBudget ? Globals::pointBudget : MESH_DEFAULT_SAMPLES);
+        if (!model.isValid())
+            return 1;
+    }
+    else if (!cloudPath.empty()) {
+        model = loadCloud(cloudPath, Globals::pointBudget);
+        if (!model.isValid())
+            return 1;
+    }
+    else {
+        cubeMesh.sampleMesh(500);
+        model = std::move(cubeMesh);
+    }
+
+    Globals::models.push_back(std::move(model));
+    Globals::displayVAO = &Globals::models[0];
+
+    if (!scenePath.empty()) {
+        if (software) {
+            cout << "Scenes are not supported by --software." << endl;
+            return 1;
+        }
+        Globals::scene = new Scene();
+        if (!Globals::scene->load(scenePath))
+            return 1;
+    }
+
+    if (software)
+        return renderSoftware(viewpoints, width, height, threads, shading, outputPrefix);
+
+#ifdef CUBE_EGL
+    if (!createContext())
+        return 1;
+#else
+    cout << "Built without EGL, only --software rendering is available." << endl;
+    return 1;
+#endif
+
+    //Glew Init, a GLX build of GLEW can not find a GLX display but loads the core functions anyway
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY)
+        err = GLEW_OK;
+#endif
+    if (GLEW_OK != err)
+    {
+        cout << "glewInit failed, aborting." << endl;
+        exit (1);
+    }
+
+    if (!Renderer::init(width, height))
+        return 1;
+
+    Renderer::resize(width, height);
+
+    //Frames are rendered right away, the attributes can not be left to the background
+    Globals::models[0].computeAttributes();
+    Globals::models[0].pushToGPU();
+    if (Globals::scene != NULL) {
+        Globals::scene->pushToGPU();
+        Globals::displayVAO = Globals::scene;
+    }
+
+    vector<unsigned char> pixels;
+    for (unsigned int i = 0; i < viewpoints.size(); i++) {
+        setView(viewpoints[i], width, height);
+
+        if (needsWarmUp())
+            Renderer::render(width, height);
+        Renderer::render(width, height);
+        Renderer::readPixels(width, height, pixels);
+
+        writeView(outputPrefix, i, width, height, pixels);
+    }
+
+    return 0;
+}
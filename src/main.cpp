@@ -50,6 +50,16 @@
 #include "orbitallight.h"
 #include "camera.h"
 #include "debugcameracallback.h"
+#include "splatcache.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "renderer.h"
+#include "residency.h"
+#include "scene.h"
+#include "generator.h"
+#include "meshsampler.h"
+#include "dynamicresolution.h"
+#include "progressive.h"
 
 #define DEBUG
 #define ITERATIONS 25
@@ -73,10 +83,6 @@ int itCounter = 0;
 ofstream logStream;
 #endif
 
-GLuint FramebufferName = 0;
-GLuint fbufferTex[4];
-GLuint depthrenderbuffer;
-
 /**
  @brief Returns a title for the window
  Concatenate 'CUBE' with the description of the shader thats its been used
@@ -105,7 +111,43 @@ const char* getTitleWindow()
     else
         fxaa = "";
 
-    Globals::title = "CUBE | " + Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].getDescription() + " | " + multipass + color + fxaa;
+    string bounds;
+    if (Globals::tightBoundsEnabled && Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].hasBoundingGeometry())
+        bounds = " (Tight Bounds)";
+    else
+        bounds = "";
+
+    string cache;
+    if (Globals::splatCacheEnabled && Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].acceptsCachedInput())
+        cache = " (Splat Cache)";
+    else
+        cache = "";
+
+    string pullPush;
+    if (Renderer::pullPushActive())
+        pullPush = " (Pull-Push)";
+    else
+        pullPush = "";
+
+    string edl;
+    if (Renderer::edlActive())
+        edl = " (EDL)";
+    else
+        edl = "";
+
+    string progressive;
+    if (Progressive::isEnabled())
+        progressive = " (Progressive)";
+    else
+        progressive = "";
+
+    string mesh;
+    if (Globals::rangeMeshEnabled && Globals::displayVAO != NULL && Globals::displayVAO->hasMesh())
+        mesh = " (Range Mesh)";
+    else
+        mesh = "";
+
+    Globals::title = "CUBE | " + Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].getDescription() + bounds + cache + pullPush + edl + progressive + mesh + " | " + multipass + color + fxaa;
     return Globals::title.c_str();
 }
 
@@ -115,7 +157,7 @@ const char* getTitleWindow()
         int width = Camera::w;
         int height = Camera::h;
         int numOfLights = Globals::sceneLightsList[ Globals::sceneLightsArrIndex % Globals::sceneLightsList.size()].size();
-        int numOfPoints = Globals::displayVAO->getCloud()->points.size();
+        size_t numOfPoints = Globals::displayVAO->getNumOfVertices();
         logStream << getTitleWindow() << "| " << numOfPoints << " Points | " << numOfLights << " Lights | " << width << "x" << height << endl;
     }
 #endif
@@ -129,55 +171,9 @@ const char* getTitleWindow()
 
 
 
-void drawWindowSizedRectangle()
-{
-    float points[] = {
-        -1.0f, -1.0f, 0.0f,
-        1.0f, -1.0f, 0.0f,
-        -1.0f,  1.0f, 0.0f,
-        -1.0f,  1.0f, 0.0f,
-        1.0f, -1.0f, 0.0f,
-        1.0f,  1.0f, 0.0f,
-    };
-
-    GLuint vbo = 0;
-    glGenBuffers (1, &vbo);
-    glBindBuffer (GL_ARRAY_BUFFER, vbo);
-    glBufferData (GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
-
-    GLuint vao = 0;
-    glGenVertexArrays (1, &vao);
-    glBindVertexArray (vao);
-    glEnableVertexAttribArray (0);
-    glBindBuffer (GL_ARRAY_BUFFER, vbo);
-    glVertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    // draw points 0-3 from the currently bound VAO with current in-use shader
-    glDrawArrays (GL_TRIANGLES, 0, 6);
-
-    glBindVertexArray(0);
-
-}
-
-
-
-
 void reshapeCallback(GLFWwindow * window, int w, int h)
 {
-    // set viewport to be the entire window
-    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
-
-    // resize framebuffer
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[0]);
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB8, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, 0);
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, 0);
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB32F, w, h, 0, GL_RGB, GL_FLOAT, 0);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, depthrenderbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, w, h);
+    Renderer::resize(w, h);
 
     if (Camera::activeCamera != NULL)
         Camera::activeCamera->updateView(w, h);
@@ -185,19 +181,6 @@ void reshapeCallback(GLFWwindow * window, int w, int h)
     #ifdef DEBUG
     writeTitleLog();
     #endif
-
-    Globals::firstTime = true;
-}
-
-
-void updateLightPosition()
-{
-    vector<Light*> lightList = Globals::sceneLightsList[ Globals::sceneLightsArrIndex % Globals::sceneLightsList.size()];
-
-    for (unsigned int i =0; i < lightList.size(); i++)
-        lightList[i]->update();
-
-    Light::pushToGPU(lightList);
 }
 
 
@@ -294,6 +277,16 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
         glUniform1i(Shader::shaderInUse->automaticRadiusEnabledLoc, Globals::automaticRadiusEnabled?1:0);
     }
 
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        Globals::tightBoundsEnabled = !Globals::tightBoundsEnabled;
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
     if (key == GLFW_KEY_C && action == GLFW_PRESS) {
         Globals::colorEnabled = !Globals::colorEnabled;
         glUniform1i(Shader::shaderInUse->colorEnabledLoc, Globals::colorEnabled?1:0);
@@ -321,6 +314,16 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
         
     }
 
+    if (key == GLFW_KEY_E && action == GLFW_PRESS) {
+        Globals::edlEnabled = !Globals::edlEnabled;
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
     if (key == GLFW_KEY_F && action == GLFW_PRESS) {
         Globals::FXAA = !Globals::FXAA;
 
@@ -332,6 +335,46 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
 
     }
 
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        Globals::rangeMeshEnabled = !Globals::rangeMeshEnabled;
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
+    if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+        Globals::pullPushEnabled = !Globals::pullPushEnabled;
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        Progressive::setEnabled(!Progressive::isEnabled());
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS) {
+        Globals::splatCacheEnabled = !Globals::splatCacheEnabled;
+        glfwSetWindowTitle(window, getTitleWindow());
+
+        #ifdef DEBUG
+        writeTitleLog();
+        #endif
+
+    }
+
     if (key == GLFW_KEY_L && action == GLFW_PRESS) {
         Globals::sceneLightsArrIndex += 1;
 
@@ -343,7 +386,7 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
 
     if (key == GLFW_KEY_M && action == GLFW_PRESS) {
         Globals::actualVAO++;
-        Globals::displayVAO = &Globals::models[Globals::actualVAO%Globals::models.size()];
+        Globals::displayVAO = Residency::use(Globals::actualVAO%Globals::models.size());
 
         #ifdef DEBUG
         writeTitleLog();
@@ -354,12 +397,11 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
         string pathToFile;
         cout << "Open File: ";
         cin >> pathToFile;
-        VAO VAO = loadCloud(pathToFile);
+        VAO VAO = loadCloud(pathToFile, Globals::pointBudget);
         if (VAO.isValid() ) {
-            Globals::models.push_back(VAO);
+            Globals::models.push_back(std::move(VAO));
             Globals::actualVAO = Globals::models.size() - 1;
-            Globals::displayVAO = &Globals::models[Globals::models.size()-1];
-            Globals::displayVAO->pushToGPU();
+            Globals::displayVAO = Residency::use(Globals::actualVAO);
         }
 
         #ifdef DEBUG
@@ -420,38 +462,10 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
         glfwSetWindowTitle(window, getTitleWindow());
     }
 
-}
-
-
-
-void applyFXAA(GLFWwindow * window)
-{
-
-    int windowWidth, windowHeight;
-    glfwGetWindowSize(window, &windowWidth, &windowHeight);
-
-    //fxaaFilter.compileShader();
-    Globals::fxaaFilter->bindShader();
-
-    //Copy framebuffer to a Texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_RECTANGLE, Globals::textureID);
-    glEnable(GL_TEXTURE_RECTANGLE);
-    if (Globals::firstTime){
-        glCopyTexImage2D(GL_TEXTURE_RECTANGLE,0, GL_RGBA16F, 0, 0, windowWidth, windowHeight, 0);
-        Globals::firstTime = false;
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        Profiler::setEnabled(!Profiler::isEnabled());
+        cout << "Profiler " << (Profiler::isEnabled() ? "enabled" : "disabled") << endl;
     }
-    else
-        glCopyTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 0, 0, windowWidth, windowHeight);
-
-    glUniform1i(Shader::shaderInUse->renderTextureLoc, 0);
-    glUniform3f(Shader::shaderInUse->inverseTextureSizeLoc, 1.0f/windowWidth, 1.0f/windowHeight, 0.0f);
-
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    drawWindowSizedRectangle();
-
-    glBindVertexArray(0);
 
 }
 
@@ -473,99 +487,20 @@ void display(GLFWwindow* window)
     glfwGetWindowSize(window, &windowWidth, &windowHeight);
 
     if (Globals::displayVAO != NULL) {
-    glBindVertexArray(Globals::displayVAO->getVAOid());
-
-    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    glViewport(0, 0, windowWidth, windowHeight);
-
-    if (Globals::displayVAO != NULL) {
-
-        if (!Globals::MultipassEnabled) {
-            Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].bindShader();
-
-            glClearColor(86.f/255.f,136.f/255.f,199.f/255.f,1.0f);
-            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glDepthFunc(GL_LEQUAL);
-            Globals::displayVAO->draw();
-        }
-        else {
-            glDepthMask(GL_TRUE);
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            Shader shaderh = Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()];
-            unsigned int indexMultipass = Globals::actualMultipass % shaderh.getMultiPass().size();
-
-            for (unsigned int i = 0; i < shaderh.getMultiPass(indexMultipass).size(); i++) {
-
-                shaderh.getMultiPass(indexMultipass)[i].bindShader();
-
-                switch (shaderh.getMultiPass(indexMultipass)[i].getMode()) {
-
-                    case shader::DEPTH_MASK:
-                    {
-                        glDepthMask(GL_TRUE);
-                        GLenum attach[2] = {GL_NONE, GL_COLOR_ATTACHMENT3};
-                        glDrawBuffers(2, attach);
-                        Globals::displayVAO->draw();
-                        break;
-                    }
-                    case shader::BLENDING:
-                    {
-                        glEnable(GL_BLEND);
-                        glDepthMask(GL_FALSE);
-                        glDepthFunc(GL_LEQUAL);
-                        GLenum attach[2] = {GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
-                        glDrawBuffers(2, attach);
-                        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-                        glClear(GL_COLOR_BUFFER_BIT);
-                        Globals::displayVAO->draw();
-                        break;
-                    }
-                    case shader::NORMALIZATION:
-                    {
-                        glActiveTexture(GL_TEXTURE0);
-                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
-                        glUniform1i(Shader::shaderInUse->blendTextureLoc, 0);
-
-                        glActiveTexture(GL_TEXTURE1);
-                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
-                        glUniform1i(Shader::shaderInUse->normalTextureLoc, 1);
-
-                        glActiveTexture(GL_TEXTURE2);
-                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
-                        glUniform1i(Shader::shaderInUse->positionTextureLoc, 2);
-
-                        //Render Texture and normalize
-                        glDrawBuffer(GL_COLOR_ATTACHMENT0);
-                        glClearColor(86.f/255.f,136.f/255.f,199.f/255.f,1.0f);
-                        glClear(GL_COLOR_BUFFER_BIT);
-                        drawWindowSizedRectangle();
-                        break;
-                    }
-                    default:
-                        break;
-                }
-
-                glDisable(GL_BLEND);
-                glDepthMask(GL_TRUE);
-            }
-
-        }
-    }
-
-    glBindVertexArray(0);
-
-    if (Globals::FXAA)
-        applyFXAA(window);
-
-    //Blit framebuffer resultant to window
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferName);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, windowWidth, windowHeight,
-                      0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-
+        //The splat passes may render below the window size, upscaled at the blit.
+        //Splats are sized in pixels, so the viewport the shaders see follows
+        int renderWidth, renderHeight;
+        DynamicResolution::renderSize(windowWidth, windowHeight, renderWidth, renderHeight);
+        Camera::w = renderWidth;
+        Camera::h = renderHeight;
+
+        DynamicResolution::beginFrame();
+        Renderer::render(renderWidth, renderHeight);
+        DynamicResolution::endFrame();
+        Renderer::present(renderWidth, renderHeight, windowWidth, windowHeight);
+
+        Camera::w = windowWidth;
+        Camera::h = windowHeight;
     }
 
 #ifdef DEBUG
@@ -582,90 +517,41 @@ void display(GLFWwindow* window)
 
 }
 
-void buildFBO()
+/**
+ @brief Updates, renders and presents one frame, then processes the events
+ @param window window to render to
+ */
+void renderFrame(GLFWwindow* window)
 {
-    // ---------------------------------------------
-    // Render to Texture - specific code begins here
-    // ---------------------------------------------
-
-    // The framebuffer, which regroups 0, 1, or more textures, and 0 or 1 depth buffer.
-    glGenFramebuffers(1, &FramebufferName);
-    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
-
-    // The texture we're going to render to
-    // The texture we're going to render to
-    glGenTextures(4, fbufferTex);
-
-    // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[0]);
-
-    // Give an empty image to OpenGL ( the last "0" means "empty" )
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB8, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-
-    // Poor filtering
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-    // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
+    Profiler::beginFrame();
 
-    // Give an empty image to OpenGL ( the last "0" means "empty" )
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, 0);
+    Profiler::beginCPU("Update");
+    Renderer::updateLightPosition();
 
-    // Poor filtering
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-    // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
-    // Give an empty image to OpenGL ( the last "0" means "empty" )
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, 0);
-    // Poor filtering
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-    //// Alternative : Depth texture. Slower, but you can sample it later in your shader
-    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
-    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB32F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_FLOAT, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    // The depth buffer
-    glGenRenderbuffers(1, &depthrenderbuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, depthrenderbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, WINDOW_WIDTH, WINDOW_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthrenderbuffer);
-
-    // Set "renderedTexture" as our colour attachement #0
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, fbufferTex[0], 0);
-
-
-    // Set "blendTexture" as our colour attachement #0
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, fbufferTex[1], 0);
+    if (Camera::activeCamera != NULL) {
+        int w, h;
+        glfwGetWindowSize(window, &w, &h);
+        Camera::activeCamera->update(w, h);
+    }
 
-    // Set "normalsTexture" as our colour attachement #0
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, fbufferTex[2], 0);
+    if (Globals::displayVAO != NULL)
+        Progressive::update(Globals::displayVAO->getNumOfVertices());
+    Profiler::endCPU();
 
-    //// Depth texture alternative :
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, fbufferTex[3], 0);
+    /* Render here */
+    Profiler::beginCPU("Submit");
+    display(window);
+    Profiler::endCPU();
 
+    /* Swap front and back buffers */
+    Profiler::beginCPU("Swap");
+    glfwSwapBuffers(window);
+    Profiler::endCPU();
 
-    // Set the list of draw buffers.
+    Profiler::endFrame();
 
-    // Always check that our framebuffer is ok
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        exit(1);
+    /* Poll for and process events */
+    glfwPollEvents();
 }
 
 
@@ -677,6 +563,55 @@ int main(int argc, char **argv)
 
     Globals::init();
 
+    string profilePath;
+    string benchmarkPath;
+    string scenePath;
+    vector<generatorSpec> generated;
+    vector<string> meshes;
+    vector<string> benchmarkClouds;
+    vector<benchmarkResolution> benchmarkResolutions;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--profile" && i + 1 < argc)
+            profilePath = argv[++i];
+        else if (arg == "--benchmark" && i + 1 < argc)
+            benchmarkPath = argv[++i];
+        else if (arg == "--cloud" && i + 1 < argc)
+            benchmarkClouds.push_back(argv[++i]);
+        else if (arg == "--resolution" && i + 1 < argc) {
+            benchmarkResolution resolution;
+            if (sscanf(argv[++i], "%dx%d", &resolution.width, &resolution.height) == 2)
+                benchmarkResolutions.push_back(resolution);
+            else
+                cout << "Wrong resolution " << argv[i] << ", expected WIDTHxHEIGHT" << endl;
+        }
+        else if (arg == "--points" && i + 1 < argc)
+            Globals::pointBudget = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--memory" && i + 1 < argc)
+            Globals::pointBudget = pointsInBudget(strtoull(argv[++i], NULL, 10) * 1024 * 1024);
+        else if (arg == "--generate" && i + 1 < argc) {
+            generatorSpec spec;
+            if (Generator::parse(argv[++i], spec))
+                generated.push_back(spec);
+            else
+                cout << "Wrong synthetic cloud " << argv[i] << ", expected [shape:]points[:seed]" << endl;
+        }
+        else if (arg == "--mesh" && i + 1 < argc)
+            meshes.push_back(argv[++i]);
+        else if (arg == "--scene" && i + 1 < argc)
+            scenePath = argv[++i];
+        else if (arg == "--vram-budget" && i + 1 < argc)
+            Residency::setBudget(strtoull(argv[++i], NULL, 10) * 1024 * 1024);
+        else if (arg == "--frame-time" && i + 1 < argc)
+            DynamicResolution::setTarget(atof(argv[++i]));
+        else if (arg == "--motion-points" && i + 1 < argc) {
+            Progressive::setEnabled(true);
+            Progressive::setMotionPoints(strtoull(argv[++i], NULL, 10));
+        }
+        else
+            cout << "Unknown argument " << argv[i] << endl;
+    }
+
     GLFWwindow* window;
 
     /* Initialize the library */
@@ -712,50 +647,8 @@ int main(int argc, char **argv)
         exit (1);
     }
 
-    if (!GLEW_EXT_framebuffer_object)
-    {
-        printf("Error: no extension GL_EXT_framebuffer_object.");
+    if (!Renderer::init(WINDOW_WIDTH, WINDOW_HEIGHT))
         return 0;
-    }
-
-    if (!GLEW_ARB_color_buffer_float)
-    {
-        printf("Error: no extension ARB_color_buffer_float.");
-        return 0;
-    }
-
-    glEnable(GL_TEXTURE_RECTANGLE);
-
-    //FrameBuffer for rendering in multipass mode
-    buildFBO();
-
-    //Texture used for normalize
-    glGenTextures(1, &Globals::textureID);
-
-    glClampColor(GL_CLAMP_READ_COLOR, GL_FALSE);
-    glClampColor(GL_CLAMP_VERTEX_COLOR, GL_FALSE);
-    glClampColor(GL_CLAMP_FRAGMENT_COLOR, GL_FALSE);
-
-
-    /*openGL configure*/
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_PROGRAM_POINT_SIZE);
-    glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, GL_LOWER_LEFT);
-    glBlendFuncSeparateEXT(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
-
-    cout << "OpenGL version: " << glGetString(GL_VERSION) << endl;
-    cout << "GLSL version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << endl;
-    cout << "GLEW version: " << glewGetString(GLEW_VERSION) << endl;
-
-    GLint maxColorAttachments;
-    glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &maxColorAttachments);
-
-    cout << "GL_MAX_COLOR_ATTACHMENTS: " << maxColorAttachments << endl;
-
-    GLint maxTextureImageUnits;
-    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureImageUnits);
-
-    cout << "GL_MAX_TEXTURE_IMAGE_UNITS: " << maxTextureImageUnits << endl;
 
     //init all models
     int w, h;
@@ -765,30 +658,37 @@ int main(int argc, char **argv)
         Camera::activeCamera->updateView(w, h);
 
     cubeMesh.sampleMesh(500);
-    Globals::models.push_back(cubeMesh);
+    Globals::models.push_back(std::move(cubeMesh));
     VAO sphere;
     sphere.sampleSphere(2000);
-    Globals::models.push_back(sphere);
-    for (unsigned int i = 0; i < Globals::models.size(); i++) {
-        Globals::models[i].pushToGPU();
+    Globals::models.push_back(std::move(sphere));
+    Globals::displayVAO = Residency::use(0);
+
+    //Synthetic clouds and sampled meshes follow the built-in models, the first one is displayed
+    size_t builtIn = Globals::models.size();
+    for (unsigned int i = 0; i < generated.size(); i++)
+        Globals::models.push_back(Generator::generateModel(generated[i]));
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        VAO mesh = MeshSampler::loadMesh(meshes[i], Globals::pointBudget ? Globals::pointBudget : MESH_DEFAULT_SAMPLES);
+        if (mesh.isValid())
+            Globals::models.push_back(std::move(mesh));
+    }
+    if (Globals::models.size() > builtIn) {
+        Globals::actualVAO = builtIn;
+        Globals::displayVAO = Residency::use(Globals::actualVAO);
     }
 
-    Globals::displayVAO = &Globals::models[0];
-
-
-    Globals::fxaaFilter->compileShader();
-
-    for (unsigned int i = 0; i < Globals::listOfShaders.size(); i ++) {
-        Globals::listOfShaders[i].compileShader();
-
-        if ( !Globals::listOfShaders[i].getMultiPass().empty()) {
-            for (unsigned int ii = 0; ii < Globals::listOfShaders[i].getMultiPass().size(); ii ++)
-                for (unsigned int iii = 0; iii < Globals::listOfShaders[i].getMultiPass(ii).size(); iii ++)
-                    Globals::listOfShaders[i].getMultiPass(ii)[iii].compileShader();
+    if (!scenePath.empty()) {
+        Globals::scene = new Scene();
+        if (Globals::scene->load(scenePath)) {
+            Globals::scene->pushToGPU();
+            Globals::displayVAO = Globals::scene;
         }
-
+        else
+            cout << "Scene " << scenePath << " has no instance." << endl;
     }
 
+
     Globals::listOfShaders[Globals::actualShader].bindShader();
 
     /*glfw Callbacks*/
@@ -797,26 +697,28 @@ int main(int argc, char **argv)
     enableMouseCallbacks(window);
     reshapeCallback(window, WINDOW_WIDTH, WINDOW_HEIGHT); //callback forced
 
-    /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window))
-    {
-        updateLightPosition();
-        
-        if (Camera::activeCamera != NULL) {
-            int w, h;
-            glfwGetWindowSize(window, &w, &h);
-            Camera::activeCamera->update(w, h);
-        }
-        
-        /* Render here */
-        display(window);
+    if (!profilePath.empty())
+        Profiler::open(profilePath);
+
+    if (!benchmarkPath.empty()) {
+        Benchmark benchmark(benchmarkPath, benchmarkClouds);
+        for (unsigned int i = 0; i < benchmarkResolutions.size(); i++)
+            benchmark.addResolution(benchmarkResolutions[i].width, benchmarkResolutions[i].height);
 
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+        disableMouseCallbacks(window);
+        glfwSetKeyCallback(window, NULL);
+        glfwSetWindowSizeCallback(window, NULL);
 
-        /* Poll for and process events */
-        glfwPollEvents();
+        if (!benchmark.run(window, renderFrame, reshapeCallback))
+            cout << "Benchmark failed." << endl;
     }
+    else {
+        /* Loop until the user closes the window */
+        while (!glfwWindowShouldClose(window))
+            renderFrame(window);
+    }
+
+    Profiler::close();
 #ifdef DEBUG
     logStream.close();
 #endif
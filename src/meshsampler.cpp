@@ -0,0 +1,233 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "meshsampler.h"
+
+#include <math.h>
+#include <thread>
+#include <algorithm>
+
+#include <pcl/io/ply_io.h>
+#include <pcl/conversions.h>
+#include <pcl/PolygonMesh.h>
+
+#include "file.h"
+#include "generator.h"
+
+//Additive recurrence of the plastic number, a 2D low-discrepancy sequence
+#define R2_STEP_U 0.7548776662466927
+#define R2_STEP_V 0.5698402909980532
+
+
+/**
+ @brief Reads the vertices, colors and faces of a PLY mesh. Polygons are split
+ in triangle fans.
+ @param path .ply file
+ @param mesh output
+ @returns false if the file can not be read or it has no face
+ */
+bool MeshSampler::readMesh(string path, triangleMesh &mesh)
+{
+    pcl::PolygonMesh polygonMesh;
+    if (pcl::io::loadPLYFile(path, polygonMesh) == -1) {
+        PCL_ERROR ("Couldn't read PLY file. \n");
+        return false;
+    }
+
+    pcl::PointCloud<pcl::PointXYZRGB> vertices;
+    pcl::fromPCLPointCloud2(polygonMesh.cloud, vertices);
+
+    bool hasColor = false;
+    for (unsigned int i = 0; i < polygonMesh.cloud.fields.size(); i++)
+        hasColor = hasColor || polygonMesh.cloud.fields[i].name == "rgb" || polygonMesh.cloud.fields[i].name == "rgba";
+
+    mesh.vertices.resize(vertices.points.size());
+    mesh.colors.resize(vertices.points.size());
+    for (size_t i = 0; i < vertices.points.size(); i++) {
+        const pcl::PointXYZRGB &vertex = vertices.points[i];
+        mesh.vertices[i] = glm::vec3(vertex.x, vertex.y, vertex.z);
+        mesh.colors[i] = hasColor ? glm::vec3(vertex.r, vertex.g, vertex.b) / 255.0f : glm::vec3(0.7f);
+    }
+
+    mesh.normals.clear();
+    mesh.indices.clear();
+    for (size_t i = 0; i < polygonMesh.polygons.size(); i++) {
+        const vector<uint32_t> &polygon = polygonMesh.polygons[i].vertices;
+        for (size_t j = 2; j < polygon.size(); j++) {
+            if (polygon[0] >= mesh.vertices.size() || polygon[j-1] >= mesh.vertices.size() || polygon[j] >= mesh.vertices.size())
+                continue;
+            mesh.indices.push_back(polygon[0]);
+            mesh.indices.push_back(polygon[j-1]);
+            mesh.indices.push_back(polygon[j]);
+        }
+    }
+
+    cout << "Mesh: " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles." << endl;
+    return !mesh.indices.empty();
+}
+
+
+/**
+ @brief Centers the bounding box of the mesh at the origin and scales it to fit in [-1, 1]
+ */
+void MeshSampler::normalizeMesh(triangleMesh &mesh)
+{
+    if (mesh.vertices.empty())
+        return;
+
+    glm::vec3 minPoint = mesh.vertices[0], maxPoint = mesh.vertices[0];
+    for (size_t i = 1; i < mesh.vertices.size(); i++) {
+        minPoint = glm::min(minPoint, mesh.vertices[i]);
+        maxPoint = glm::max(maxPoint, mesh.vertices[i]);
+    }
+
+    glm::vec3 center = (minPoint + maxPoint) * 0.5f;
+    glm::vec3 halfExtent = (maxPoint - minPoint) * 0.5f;
+    float scale = max(max(halfExtent.x, halfExtent.y), halfExtent.z);
+    if (scale <= 0)
+        scale = 1.0f;
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+        mesh.vertices[i] = (mesh.vertices[i] - center) / scale;
+}
+
+
+/**
+ @brief Samples numOfPoints surfels from the triangles. Sample i lies at
+ (i + jitter) / numOfPoints along the prefix sum of the areas, so triangle t
+ holds the samples from firstSample(t) on, and the k-th of them is placed with
+ the k-th value of the low-discrepancy sequence. Each thread looks up its first
+ triangle and walks forward. The result does not depend on the thread count.
+ @param mesh triangles
+ @param numOfPoints samples
+ @param seed of the jitter and of the sequence offsets
+ @param points output, radii included
+ @param numOfThreads threads used, 0 for every core
+ @returns radius of the samples
+ */
+float MeshSampler::sample(const triangleMesh &mesh, size_t numOfPoints, uint64_t seed, PointStore &points, unsigned int numOfThreads)
+{
+    if (numOfThreads == 0)
+        numOfThreads = max(thread::hardware_concurrency(), 1u);
+
+    size_t numOfTriangles = mesh.indices.size() / 3;
+    points.clear();
+    if (numOfTriangles == 0 || numOfPoints == 0)
+        return 0.0f;
+
+    //Prefix sum of the areas: per thread sums, then each range adds the sums of the previous ones
+    vector<double> areaSum(numOfTriangles);
+    vector<double> threadSum(numOfThreads + 1, 0.0);
+    parallelRanges(numOfTriangles, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+        double sum = 0;
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3 a = mesh.vertices[mesh.indices[3*i]];
+            glm::vec3 b = mesh.vertices[mesh.indices[3*i+1]];
+            glm::vec3 c = mesh.vertices[mesh.indices[3*i+2]];
+            sum += 0.5 * glm::length(glm::cross(b - a, c - a));
+            areaSum[i] = sum;
+        }
+        threadSum[t + 1] = sum;
+    });
+    for (unsigned int t = 0; t < numOfThreads; t++)
+        threadSum[t + 1] += threadSum[t];
+    parallelRanges(numOfTriangles, numOfThreads, [&] (size_t begin, size_t end, unsigned int t) {
+        for (size_t i = begin; i < end; i++)
+            areaSum[i] += threadSum[t];
+    });
+
+    double totalArea = areaSum[numOfTriangles - 1];
+    if (totalArea <= 0)
+        return 0.0f;
+
+    double jitter = Generator::random(seed, ~0ULL, 0);
+    double step = totalArea / numOfPoints;
+    float radius = sqrt(GENERATOR_NEIGHBOURS * totalArea / (M_PI * numOfPoints));
+
+    points.resize(numOfPoints);
+    points.radius.assign(numOfPoints, radius);
+
+    parallelRanges(numOfPoints, numOfThreads, [&] (size_t begin, size_t end, unsigned int) {
+        if (begin == end)
+            return;
+
+        size_t t = upper_bound(areaSum.begin(), areaSum.end(), (begin + jitter) * step) - areaSum.begin();
+        t = min(t, numOfTriangles - 1);
+
+        for (size_t i = begin; i < end; i++) {
+            double position = (i + jitter) * step;
+            while (t < numOfTriangles - 1 && areaSum[t] <= position)
+                t++;
+
+            double before = (t > 0) ? areaSum[t - 1] : 0.0;
+            double first = max(ceil(before / step - jitter), 0.0);
+            size_t k = (first < i) ? i - (size_t) first : 0;
+
+            double u = Generator::random(seed, t, 0) + k * R2_STEP_U;
+            double v = Generator::random(seed, t, 1) + k * R2_STEP_V;
+            u -= floor(u);
+            v -= floor(v);
+            if (u + v > 1.0) {
+                u = 1.0 - u;
+                v = 1.0 - v;
+            }
+
+            unsigned int ia = mesh.indices[3*t], ib = mesh.indices[3*t+1], ic = mesh.indices[3*t+2];
+            glm::vec3 a = mesh.vertices[ia], b = mesh.vertices[ib], c = mesh.vertices[ic];
+            glm::vec3 normal = mesh.normals.empty() ? glm::normalize(glm::cross(b - a, c - a)) : mesh.normals[t];
+            glm::vec3 color = float(1.0 - u - v) * mesh.colors[ia] + float(u) * mesh.colors[ib] + float(v) * mesh.colors[ic];
+
+            points.setPoint(i, a + float(u) * (b - a) + float(v) * (c - a), normal, color);
+        }
+    });
+
+    return radius;
+}
+
+
+/**
+ @returns VAO with numOfPoints surfels of the mesh stored in a PLY file, not
+ valid if it can not be read
+ */
+VAO MeshSampler::loadMesh(string path, size_t numOfPoints)
+{
+    triangleMesh mesh;
+    if (!readMesh(path, mesh))
+        return VAO();
+
+    normalizeMesh(mesh);
+
+    cout << endl << "Sampling " << numOfPoints << " surfels ..." << endl;
+    PointStore points;
+    float radius = sample(mesh, numOfPoints, 0, points);
+
+    //Same spatial order as loaded clouds, the radius is the same for every surfel
+    sortMorton(points);
+    points.radius.assign(points.size(), radius);
+
+    return VAO(std::move(points));
+}
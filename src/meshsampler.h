@@ -0,0 +1,72 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__meshsampler__
+#define __CUBE__meshsampler__
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include "pointstore.h"
+#include "vao.h"
+
+#define MESH_DEFAULT_SAMPLES 1000000 //surfels of a mesh when no point budget is set
+
+using namespace std;
+
+struct triangleMesh {
+    vector<glm::vec3> vertices;
+    vector<glm::vec3> colors;           //per vertex, in [0, 1]
+    vector<glm::vec3> normals;          //per triangle, taken from the winding if empty
+    vector<unsigned int> indices;       //three per triangle
+};
+
+/**
+ @brief Converts triangle meshes to surfels. Samples are spread by area with
+ stratified sampling along the prefix sum of the triangle areas, so every
+ triangle gets its share of samples within one, and placed inside each
+ triangle along a low-discrepancy sequence. The density is uniform, so the
+ radius is known without a neighbour search.
+ */
+class MeshSampler {
+
+private:
+    MeshSampler();
+
+public:
+    static bool readMesh(string path, triangleMesh &mesh);
+    static void normalizeMesh(triangleMesh &mesh);
+    static float sample(const triangleMesh &mesh, size_t numOfPoints, uint64_t seed, PointStore &points, unsigned int numOfThreads = 0);
+    static VAO loadMesh(string path, size_t numOfPoints);
+
+};
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "pointstore.h"
+
+
+/**
+ @returns host bytes used by the points, radius and triangles included
+ */
+size_t PointStore::getBytes() const
+{
+    return (x.capacity() + y.capacity() + z.capacity() + nx.capacity() + ny.capacity() + nz.capacity() + radius.capacity()) * sizeof(float)
+         + r.capacity() + g.capacity() + b.capacity() + triangles.capacity() * sizeof(uint32_t);
+}
+
+
+/**
+ @brief Resizes every attribute but the radius, which is computed later. The
+ store is not organized anymore.
+ */
+void PointStore::resize(size_t numOfPoints)
+{
+    width = numOfPoints;
+    height = 1;
+    x.resize(numOfPoints);
+    y.resize(numOfPoints);
+    z.resize(numOfPoints);
+    nx.resize(numOfPoints);
+    ny.resize(numOfPoints);
+    nz.resize(numOfPoints);
+    r.resize(numOfPoints);
+    g.resize(numOfPoints);
+    b.resize(numOfPoints);
+}
+
+
+void PointStore::clear()
+{
+    PointStore empty;
+    swap(*this, empty);
+}
+
+
+/**
+ @param color in [0, 1]
+ */
+void PointStore::setPoint(size_t i, glm::vec3 position, glm::vec3 normal, glm::vec3 color)
+{
+    x[i] = position.x;
+    y[i] = position.y;
+    z[i] = position.z;
+    nx[i] = normal.x;
+    ny[i] = normal.y;
+    nz[i] = normal.z;
+    r[i] = color.r * 255;
+    g[i] = color.g * 255;
+    b[i] = color.b * 255;
+}
+
+
+/**
+ @brief Copies point j of source to point i, with its radius if both have one
+ */
+void PointStore::copyPoint(size_t i, const PointStore &source, size_t j)
+{
+    x[i] = source.x[j];
+    y[i] = source.y[j];
+    z[i] = source.z[j];
+    nx[i] = source.nx[j];
+    ny[i] = source.ny[j];
+    nz[i] = source.nz[j];
+    r[i] = source.r[j];
+    g[i] = source.g[j];
+    b[i] = source.b[j];
+    if (!radius.empty() && !source.radius.empty())
+        radius[i] = source.radius[j];
+}
+
+
+/**
+ @brief Keeps the points listed in order, in that order. The cloud is not
+ organized anymore, but its triangles follow the points.
+ @param order indices of the points to keep, may be shorter than the store
+ */
+void PointStore::reorder(const vector<size_t> &order)
+{
+    PointStore reordered;
+    reordered.resize(order.size());
+    if (!radius.empty())
+        reordered.radius.resize(order.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+        reordered.copyPoint(i, *this, order[i]);
+    reordered.triangles = reorderTriangles(order);
+
+    swap(*this, reordered);
+}
+
+
+/**
+ @brief Triangles renumbered for the points listed in order, see reorder.
+ Those with a vertex left out are dropped.
+ @param order indices of the points kept
+ @returns three point indices per triangle
+ */
+vector<uint32_t> PointStore::reorderTriangles(const vector<size_t> &order) const
+{
+    vector<uint32_t> reordered;
+    if (triangles.empty())
+        return reordered;
+
+    const uint32_t removed = UINT32_MAX;
+    vector<uint32_t> position(size(), removed);
+    for (size_t i = 0; i < order.size(); i++)
+        position[order[i]] = i;
+
+    reordered.reserve(triangles.size());
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        uint32_t a = position[triangles[i]];
+        uint32_t b = position[triangles[i + 1]];
+        uint32_t c = position[triangles[i + 2]];
+        if (a != removed && b != removed && c != removed) {
+            reordered.push_back(a);
+            reordered.push_back(b);
+            reordered.push_back(c);
+        }
+    }
+
+    return reordered;
+}
+
+
+void PointStore::fromPCL(const CloudType &cloud)
+{
+    clear();
+    resize(cloud.points.size());
+    width = cloud.width;
+    height = cloud.height;
+
+    for (size_t i = 0; i < cloud.points.size(); i++) {
+        const pcl::PointXYZRGBNormal &point = cloud.points[i];
+        x[i] = point.x;
+        y[i] = point.y;
+        z[i] = point.z;
+        nx[i] = point.normal_x;
+        ny[i] = point.normal_y;
+        nz[i] = point.normal_z;
+        r[i] = point.r;
+        g[i] = point.g;
+        b[i] = point.b;
+    }
+}
+
+
+void PointStore::toPCL(CloudType &cloud) const
+{
+    cloud.points.resize(size());
+    cloud.width = isOrganized() ? width : size();
+    cloud.height = isOrganized() ? height : 1;
+    cloud.is_dense = true;
+
+    for (size_t i = 0; i < size(); i++) {
+        pcl::PointXYZRGBNormal &point = cloud.points[i];
+        point.x = x[i];
+        point.y = y[i];
+        point.z = z[i];
+        point.normal_x = nx[i];
+        point.normal_y = ny[i];
+        point.normal_z = nz[i];
+        point.r = r[i];
+        point.g = g[i];
+        point.b = b[i];
+    }
+}
+
+
+/**
+ @brief Positions only, all a neighbour search needs. Clouds past
+ POINTSTORE_SEARCH_BLOCK points are searched one block of consecutive points at
+ a time, spatially compact once Morton sorted.
+ @param first, count points copied
+ */
+void PointStore::positionsToPCL(pcl::PointCloud<pcl::PointXYZ> &cloud, size_t first, size_t count) const
+{
+    cloud.points.resize(count);
+    cloud.width = count;
+    cloud.height = 1;
+    cloud.is_dense = true;
+
+    for (size_t i = 0; i < count; i++)
+        cloud.points[i] = pcl::PointXYZ(x[first + i], y[first + i], z[first + i]);
+}
@@ -0,0 +1,134 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__pointstore__
+#define __CUBE__pointstore__
+
+#include <iostream>
+#include <vector>
+#include <new>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+#define POINTSTORE_ALIGNMENT 32 //bytes, one AVX register
+#define POINTSTORE_SEARCH_BLOCK ((size_t) 1 << 30) //points per kd-tree, PCL indexes them with int
+
+using namespace std;
+
+typedef pcl::PointCloud<pcl::PointXYZRGBNormal> CloudType;
+
+//Allocator of POINTSTORE_ALIGNMENT aligned blocks, so every array starts on a SIMD boundary
+template <typename T>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    AlignedAllocator() {};
+    template <typename U> AlignedAllocator(const AlignedAllocator<U> &) {};
+
+    T *allocate(size_t n)
+    {
+        void *block = NULL;
+#ifdef _WIN32
+        block = _aligned_malloc(n * sizeof(T), POINTSTORE_ALIGNMENT);
+#else
+        if (posix_memalign(&block, POINTSTORE_ALIGNMENT, n * sizeof(T)) != 0)
+            block = NULL;
+#endif
+        if (block == NULL && n > 0)
+            throw bad_alloc();
+        return (T*) block;
+    };
+
+    void deallocate(T *block, size_t)
+    {
+#ifdef _WIN32
+        _aligned_free(block);
+#else
+        free(block);
+#endif
+    };
+
+    template <typename U> bool operator==(const AlignedAllocator<U> &) const { return true; };
+    template <typename U> bool operator!=(const AlignedAllocator<U> &) const { return false; };
+};
+
+typedef vector<float, AlignedAllocator<float> > floatArray;
+typedef vector<uint8_t, AlignedAllocator<uint8_t> > byteArray;
+
+/**
+ @brief Host copy of a cloud as a structure of arrays: 31 bytes per point with
+ its radius, against the 48 of a padded pcl::PointXYZRGBNormal. Converted to PCL
+ only for the algorithms taken from it (parsing, normals and neighbour search).
+ */
+class PointStore
+{
+
+public:
+    floatArray x, y, z;         //position
+    floatArray nx, ny, nz;      //normal, null if unknown
+    byteArray r, g, b;          //color
+    floatArray radius;          //splat radius, empty until computed
+    size_t width, height;       //grid of an organized cloud, height is 1 otherwise
+    vector<uint32_t> triangles; //range image mesh of an organized cloud, three point indices each
+
+    PointStore() { width = 0; height = 1; };
+
+    size_t size() const { return x.size(); };
+    bool empty() const { return x.empty(); };
+    bool isOrganized() const { return height > 1 && width * height == size(); };
+    bool hasMesh() const { return !triangles.empty(); };
+    size_t getBytes() const;
+
+    void resize(size_t numOfPoints);
+    void clear();
+
+    glm::vec3 getPosition(size_t i) const { return glm::vec3(x[i], y[i], z[i]); };
+    glm::vec3 getNormal(size_t i) const { return glm::vec3(nx[i], ny[i], nz[i]); };
+    glm::vec3 getColor(size_t i) const { return glm::vec3(r[i], g[i], b[i]) / 255.0f; };
+    void setPoint(size_t i, glm::vec3 position, glm::vec3 normal, glm::vec3 color);
+    void copyPoint(size_t i, const PointStore &source, size_t j);
+
+    void reorder(const vector<size_t> &order);
+    vector<uint32_t> reorderTriangles(const vector<size_t> &order) const;
+
+    void fromPCL(const CloudType &cloud);
+    void toPCL(CloudType &cloud) const;
+    void positionsToPCL(pcl::PointCloud<pcl::PointXYZ> &cloud) const { positionsToPCL(cloud, 0, size()); };
+    void positionsToPCL(pcl::PointCloud<pcl::PointXYZ> &cloud, size_t first, size_t count) const;
+    size_t numOfSearchBlocks() const { return numOfSearchBlocks(size()); };
+    static size_t numOfSearchBlocks(size_t numOfPoints) { return (numOfPoints + POINTSTORE_SEARCH_BLOCK - 1) / POINTSTORE_SEARCH_BLOCK; };
+
+};
+
+#endif
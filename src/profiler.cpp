@@ -0,0 +1,317 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "profiler.h"
+
+bool Profiler::enabled = false;
+long Profiler::frame = 0;
+profilerFrame Profiler::frames[2];
+vector<GLuint> Profiler::queryPool[2];
+unsigned int Profiler::queriesUsed = 0;
+bool Profiler::passOpen = false;
+string Profiler::cpuName;
+std::chrono::steady_clock::time_point Profiler::cpuStart;
+ofstream Profiler::output;
+bool Profiler::json = false;
+bool Profiler::firstRecord = true;
+vector<string> Profiler::reportNames;
+vector<double> Profiler::reportTimes;
+int Profiler::reportFrames = 0;
+
+
+/**
+ @brief Starts or stops profiling. Frames in flight are dropped when stopping.
+ @param enabled new state
+ */
+void Profiler::setEnabled(bool enabled)
+{
+    Profiler::enabled = enabled;
+
+    frames[0].pending = false;
+    frames[1].pending = false;
+    reportNames.clear();
+    reportTimes.clear();
+    reportFrames = 0;
+}
+
+
+/**
+ @brief Opens the file the frames are exported to, JSON if its extension is
+ .json and CSV otherwise. Enables the profiler.
+ @param path output file
+ @returns false if the file can not be created
+ */
+bool Profiler::open(string path)
+{
+    output.open(path.c_str());
+
+    if (!output.is_open()) {
+        cout << "Can not open profiler output " << path << endl;
+        return false;
+    }
+
+    json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    firstRecord = true;
+
+    if (json)
+        output << "[" << endl;
+    else
+        output << "frame,kind,name,value" << endl;
+
+    setEnabled(true);
+    return true;
+}
+
+
+void Profiler::close()
+{
+    if (!output.is_open())
+        return;
+
+    if (json)
+        output << endl << "]" << endl;
+
+    output.close();
+}
+
+
+GLuint Profiler::nextQuery()
+{
+    vector<GLuint> &pool = queryPool[frame % 2];
+
+    if (queriesUsed == pool.size()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        pool.push_back(query);
+    }
+
+    return pool[queriesUsed++];
+}
+
+
+void Profiler::beginFrame()
+{
+    if (!enabled)
+        return;
+
+    profilerFrame &record = current();
+
+    record.frame = frame;
+    record.passNames.clear();
+    record.passQueries.clear();
+    record.cpuNames.clear();
+    record.cpuTimes.clear();
+    record.points = 0;
+    record.drawCalls = 0;
+    record.pending = true;
+    queriesUsed = 0;
+
+    record.timestamps[0] = nextQuery();
+    record.timestamps[1] = nextQuery();
+    glQueryCounter(record.timestamps[0], GL_TIMESTAMP);
+}
+
+
+/**
+ @brief Closes the frame and resolves the previous one, whose queries had a
+ whole frame to complete
+ */
+void Profiler::endFrame()
+{
+    if (!enabled)
+        return;
+
+    if (passOpen)
+        endPass();
+
+    glQueryCounter(current().timestamps[1], GL_TIMESTAMP);
+
+    frame++;
+
+    if (current().pending)
+        resolve(current());
+}
+
+
+void Profiler::beginPass(string name)
+{
+    if (!enabled)
+        return;
+
+    if (passOpen)
+        endPass();
+
+    GLuint query = nextQuery();
+    current().passNames.push_back(name);
+    current().passQueries.push_back(query);
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    passOpen = true;
+}
+
+
+void Profiler::endPass()
+{
+    if (!enabled || !passOpen)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    passOpen = false;
+}
+
+
+void Profiler::beginCPU(string name)
+{
+    if (!enabled)
+        return;
+
+    cpuName = name;
+    cpuStart = std::chrono::steady_clock::now();
+}
+
+
+void Profiler::endCPU()
+{
+    if (!enabled)
+        return;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - cpuStart;
+    current().cpuNames.push_back(cpuName);
+    current().cpuTimes.push_back(elapsed.count());
+}
+
+
+/**
+ @brief Counts a draw call
+ @param points points submitted by the draw call, 0 if only the GPU knows them
+ */
+void Profiler::countDraw(long points)
+{
+    if (!enabled)
+        return;
+
+    current().points += points;
+    current().drawCalls++;
+}
+
+
+void Profiler::resolve(profilerFrame &record)
+{
+    vector<double> passTimes;
+
+    for (unsigned int i = 0; i < record.passQueries.size(); i++) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(record.passQueries[i], GL_QUERY_RESULT, &elapsed);
+        passTimes.push_back(elapsed / 1.0e6);
+    }
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(record.timestamps[0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(record.timestamps[1], GL_QUERY_RESULT, &end);
+    double gpuFrameTime = (end - begin) / 1.0e6;
+
+    if (output.is_open())
+        write(record, passTimes, gpuFrameTime);
+
+    report(record, passTimes, gpuFrameTime);
+
+    record.pending = false;
+}
+
+
+void Profiler::write(profilerFrame &record, vector<double> &passTimes, double gpuFrameTime)
+{
+    if (json) {
+        if (!firstRecord)
+            output << "," << endl;
+
+        output << "  {\"frame\": " << record.frame << ", \"gpuFrame\": " << gpuFrameTime;
+
+        output << ", \"gpu\": {";
+        for (unsigned int i = 0; i < passTimes.size(); i++)
+            output << (i ? ", " : "") << "\"" << record.passNames[i] << "\": " << passTimes[i];
+
+        output << "}, \"cpu\": {";
+        for (unsigned int i = 0; i < record.cpuTimes.size(); i++)
+            output << (i ? ", " : "") << "\"" << record.cpuNames[i] << "\": " << record.cpuTimes[i];
+
+        output << "}, \"points\": " << record.points << ", \"drawCalls\": " << record.drawCalls << "}";
+    }
+    else {
+        output << record.frame << ",gpu,Frame," << gpuFrameTime << endl;
+
+        for (unsigned int i = 0; i < passTimes.size(); i++)
+            output << record.frame << ",gpu," << record.passNames[i] << "," << passTimes[i] << endl;
+
+        for (unsigned int i = 0; i < record.cpuTimes.size(); i++)
+            output << record.frame << ",cpu," << record.cpuNames[i] << "," << record.cpuTimes[i] << endl;
+
+        output << record.frame << ",counter,Points," << record.points << endl;
+        output << record.frame << ",counter,Draw Calls," << record.drawCalls << endl;
+    }
+
+    firstRecord = false;
+}
+
+
+void Profiler::accumulate(string name, double time)
+{
+    for (unsigned int i = 0; i < reportNames.size(); i++)
+        if (reportNames[i] == name) {
+            reportTimes[i] += time;
+            return;
+        }
+
+    reportNames.push_back(name);
+    reportTimes.push_back(time);
+}
+
+
+/**
+ @brief Prints the average time of every pass & phase each PROFILER_REPORT_FRAMES frames
+ */
+void Profiler::report(profilerFrame &record, vector<double> &passTimes, double gpuFrameTime)
+{
+    accumulate("GPU Frame", gpuFrameTime);
+    for (unsigned int i = 0; i < passTimes.size(); i++)
+        accumulate("GPU " + record.passNames[i], passTimes[i]);
+    for (unsigned int i = 0; i < record.cpuTimes.size(); i++)
+        accumulate("CPU " + record.cpuNames[i], record.cpuTimes[i]);
+    accumulate("Points", record.points);
+    accumulate("Draw Calls", record.drawCalls);
+
+    if (++reportFrames < PROFILER_REPORT_FRAMES)
+        return;
+
+    cout << "Profiler (" << reportFrames << " frames average)" << endl;
+    for (unsigned int i = 0; i < reportNames.size(); i++)
+        cout << "  " << reportNames[i] << ": " << reportTimes[i] / reportFrames << endl;
+
+    reportNames.clear();
+    reportTimes.clear();
+    reportFrames = 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__profiler__
+#define __CUBE__profiler__
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include <GL/glew.h>
+
+#define PROFILER_REPORT_FRAMES 60 //frames averaged in each console report
+
+using namespace std;
+
+//Measurements of one frame, resolved one frame later so GPU queries never stall
+struct profilerFrame {
+    long frame;
+    vector<string> passNames;
+    vector<GLuint> passQueries;         //GL_TIME_ELAPSED, one per pass
+    GLuint timestamps[2];               //GL_TIMESTAMP at frame begin & end
+    vector<string> cpuNames;
+    vector<double> cpuTimes;            //milliseconds
+    long points;
+    int drawCalls;
+    bool pending;
+};
+
+class Profiler {
+
+private:
+    Profiler();
+
+    static bool enabled;
+    static long frame;
+    static profilerFrame frames[2];     //double buffered: one recording, one in flight
+    static vector<GLuint> queryPool[2];
+    static unsigned int queriesUsed;
+    static bool passOpen;
+    static string cpuName;
+    static std::chrono::steady_clock::time_point cpuStart;
+
+    static ofstream output;
+    static bool json;
+    static bool firstRecord;
+
+    //Console report
+    static vector<string> reportNames;
+    static vector<double> reportTimes;
+    static int reportFrames;
+
+    static profilerFrame &current() { return frames[frame % 2]; };
+    static GLuint nextQuery();
+    static void resolve(profilerFrame &record);
+    static void write(profilerFrame &record, vector<double> &passTimes, double gpuFrameTime);
+    static void report(profilerFrame &record, vector<double> &passTimes, double gpuFrameTime);
+    static void accumulate(string name, double time);
+
+public:
+    static bool isEnabled() { return enabled; };
+    static void setEnabled(bool enabled);
+    static bool open(string path);
+    static void close();
+
+    //Frame
+    static void beginFrame();
+    static void endFrame();
+
+    //GPU time of a pass, passes can not be nested
+    static void beginPass(string name);
+    static void endPass();
+
+    //CPU time of a phase, phases can not be nested
+    static void beginCPU(string name);
+    static void endCPU();
+
+    //Counters
+    static void countDraw(long points);
+
+};
+
+#endif
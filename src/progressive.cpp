@@ -0,0 +1,73 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+
+#include "progressive.h"
+
+#include "camera.h"
+
+#include <math.h>
+
+bool Progressive::enabled = false;
+size_t Progressive::motionPoints = PROGRESSIVE_MOTION_POINTS;
+size_t Progressive::stride = 1;
+glm::mat4 Progressive::lastView;
+
+
+/**
+ @returns factor of the splat radii, the spacing of the subset on a surface
+ */
+float Progressive::getRadiusScale()
+{
+    return sqrt((float) stride);
+}
+
+
+/**
+ @brief Chooses the subset of the next frame: the one within the motion budget
+ if the view changed since the last frame, otherwise twice as many points as
+ the last one
+ @param numOfVertices points of the displayed model
+ */
+void Progressive::update(size_t numOfVertices)
+{
+    bool moving = (Camera::viewMatrix != lastView);
+    lastView = Camera::viewMatrix;
+
+    if (!enabled) {
+        stride = 1;
+        return;
+    }
+
+    if (moving) {
+        stride = 1;
+        while (numOfVertices > stride * motionPoints && stride < PROGRESSIVE_MAX_STRIDE)
+            stride *= 2;
+    }
+    else if (stride > 1)
+        stride /= 2;
+}
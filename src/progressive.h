@@ -0,0 +1,72 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+
+#ifndef __CUBE__progressive__
+#define __CUBE__progressive__
+
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#define PROGRESSIVE_MOTION_POINTS 4000000   //points drawn per frame while the camera moves
+#define PROGRESSIVE_MAX_STRIDE 64           //keeps the attribute strides under the 2048 bytes drivers accept
+
+using namespace std;
+
+/**
+ @brief Draws a subset of the displayed model while the camera moves, every
+ stride-th point of each chunk with the splat radii scaled by the square root
+ of the stride so the surface stays closed. Points are stored in Morton order,
+ so the subset is spread over the whole model. Once the view is still the
+ stride halves every frame, each subset containing the previous one, until
+ every point is drawn at its own radius.
+ */
+class Progressive {
+
+private:
+    Progressive();
+
+    static bool enabled;
+    static size_t motionPoints;
+    static size_t stride;           //power of two, 1 draws every point
+    static glm::mat4 lastView;
+
+public:
+    static void setEnabled(bool enabled) { Progressive::enabled = enabled; };
+    static bool isEnabled() { return enabled; };
+    static void setMotionPoints(size_t points) { motionPoints = points; };
+
+    static size_t getStride() { return stride; };
+    static float getRadiusScale();
+    static bool isRefining() { return stride > 1; };
+
+    static void update(size_t numOfVertices);
+
+};
+
+#endif
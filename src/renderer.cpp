@@ -0,0 +1,916 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "renderer.h"
+
+#include "globals.h"
+#include "shader.h"
+#include "light.h"
+#include "camera.h"
+#include "splatcache.h"
+#include "profiler.h"
+#include "scene.h"
+
+int Renderer::framebufferWidth = 0;
+int Renderer::framebufferHeight = 0;
+GLuint Renderer::FramebufferName = 0;
+GLuint Renderer::fbufferTex[4];
+GLuint Renderer::depthrenderbuffer;
+GLuint Renderer::tileFramebufferName = 0;
+GLuint Renderer::tileDepthTex;
+GLuint Renderer::tileHistoryTex;
+GLuint Renderer::tileVAO = 0;
+GLuint Renderer::quadVAO = 0;
+GLuint Renderer::quadVBO = 0;
+glm::mat4 Renderer::previousViewMatrix(1.0f);
+glm::mat4 Renderer::previousProjMatrix(1.0f);
+int Renderer::previousWidth = 0;
+int Renderer::previousHeight = 0;
+GLuint Renderer::depthCopyTex;
+GLuint Renderer::colorCopyTex;
+vector<pyramidLevel> Renderer::pyramid;
+int Renderer::pyramidWidth = 0;
+int Renderer::pyramidHeight = 0;
+
+
+/**
+ @brief Checks the extensions needed, builds the offscreen framebuffer, sets the
+ OpenGL state and compiles every shader. Needs a current context with GLEW initialized.
+ @param width, height initial size of the framebuffer
+ @returns false if the context lacks a needed extension
+ */
+bool Renderer::init(int width, int height)
+{
+    if (!GLEW_EXT_framebuffer_object)
+    {
+        cout << "Error: no extension GL_EXT_framebuffer_object." << endl;
+        return false;
+    }
+
+    if (!GLEW_ARB_color_buffer_float)
+    {
+        cout << "Error: no extension ARB_color_buffer_float." << endl;
+        return false;
+    }
+
+    glEnable(GL_TEXTURE_RECTANGLE);
+
+    //FrameBuffer for rendering in multipass mode
+    buildFBO(width, height);
+
+    //Texture used for normalize
+    glGenTextures(1, &Globals::textureID);
+
+    glClampColor(GL_CLAMP_READ_COLOR, GL_FALSE);
+    glClampColor(GL_CLAMP_VERTEX_COLOR, GL_FALSE);
+    glClampColor(GL_CLAMP_FRAGMENT_COLOR, GL_FALSE);
+
+
+    /*openGL configure*/
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, GL_LOWER_LEFT);
+    glBlendFuncSeparateEXT(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+    Scene::resetModelMatrix();
+
+    cout << "OpenGL version: " << glGetString(GL_VERSION) << endl;
+    cout << "GLSL version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << endl;
+    cout << "GLEW version: " << glewGetString(GLEW_VERSION) << endl;
+
+    GLint maxColorAttachments;
+    glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &maxColorAttachments);
+
+    cout << "GL_MAX_COLOR_ATTACHMENTS: " << maxColorAttachments << endl;
+
+    GLint maxTextureImageUnits;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureImageUnits);
+
+    cout << "GL_MAX_TEXTURE_IMAGE_UNITS: " << maxTextureImageUnits << endl;
+
+    Globals::fxaaFilter->compileShader();
+    Globals::rangeMeshShader->compileShader();
+    Globals::edlShader->compileShader();
+    Globals::pullShader->compileShader();
+    Globals::pushShader->compileShader();
+
+    for (unsigned int i = 0; i < Globals::listOfShaders.size(); i ++) {
+        Globals::listOfShaders[i].compileShader();
+
+        if ( !Globals::listOfShaders[i].getMultiPass().empty()) {
+            for (unsigned int ii = 0; ii < Globals::listOfShaders[i].getMultiPass().size(); ii ++)
+                for (unsigned int iii = 0; iii < Globals::listOfShaders[i].getMultiPass(ii).size(); iii ++)
+                    Globals::listOfShaders[i].getMultiPass(ii)[iii].compileShader();
+        }
+
+    }
+
+    return true;
+}
+
+
+/**
+ @brief Resizes the offscreen framebuffer
+ @param w, h new size
+ */
+void Renderer::resize(int w, int h)
+{
+    // set viewport to be the entire window
+    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+    framebufferWidth = w;
+    framebufferHeight = h;
+
+    // resize framebuffer
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[0]);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB8, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, 0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, 0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB32F, w, h, 0, GL_RGB, GL_FLOAT, 0);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depthrenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, w, h);
+
+    glBindTexture(GL_TEXTURE_RECTANGLE, depthCopyTex);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_DEPTH_COMPONENT24, w, h, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+
+    //The tile depths of the previous frame are lost, nothing to reproject
+    glBindTexture(GL_TEXTURE_RECTANGLE, tileDepthTex);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RG32F, (w + TILE_SIZE - 1)/TILE_SIZE, (h + TILE_SIZE - 1)/TILE_SIZE, 0, GL_RG, GL_FLOAT, 0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, tileHistoryTex);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RG32F, (w + TILE_SIZE - 1)/TILE_SIZE, (h + TILE_SIZE - 1)/TILE_SIZE, 0, GL_RG, GL_FLOAT, 0);
+    previousWidth = previousHeight = 0;
+
+    Globals::firstTime = true;
+}
+
+
+void Renderer::drawWindowSizedRectangle()
+{
+    // draw the quad built with the framebuffer with current in-use shader
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    glBindVertexArray(0);
+
+}
+
+
+
+/**
+ @brief Name of a pass in the profiler output
+ @param mode pass mode
+ @returns name
+ */
+string Renderer::passName(shaderMode mode)
+{
+    switch (mode) {
+        case shader::DEPTH_MASK:        return "Visibility";
+        case shader::BLENDING:          return "Blending";
+        case shader::NORMALIZATION:     return "Normalization";
+        case shader::WEIGHTED_BLENDING: return "Weighted Blending";
+        case shader::TILE_DEPTH:        return "Tile Depth";
+        case shader::TILE_REPROJECTION: return "Tile Reprojection";
+        default:                        return "Splatting";
+    }
+}
+
+
+/**
+ @brief Draws the splats of the displayed model with the shader in use, reading
+ the splat cache when the shader accepts camera space input
+ */
+void Renderer::drawSplats()
+{
+    if (Globals::splatCacheEnabled && Shader::shaderInUse->acceptsCachedInput())
+        Globals::splatCache->draw();
+    else {
+        glBindVertexArray(Globals::displayVAO->getVAOid());
+        Globals::displayVAO->draw(Shader::shaderInUse->getStreams());
+    }
+}
+
+
+/**
+ @brief Draws the range image mesh of the displayed model, lit by the current
+ set of lights, with about one fragment per pixel
+ */
+void Renderer::drawRangeMesh()
+{
+    Profiler::beginPass("Range Mesh");
+    Globals::rangeMeshShader->bindShader();
+
+    glClearColor(86.f/255.f,136.f/255.f,199.f/255.f,1.0f);
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDepthFunc(GL_LEQUAL);
+    Globals::displayVAO->drawMesh();
+    Profiler::endPass();
+}
+
+
+/**
+ @brief Starts the background estimation of the normals & radii of the displayed
+ model once the selected shader or flags read them, and patches them into its
+ buffers when they are ready
+ */
+void Renderer::updateAttributes()
+{
+    Shader &shader = Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()];
+
+    if (shader.readsSurfaceAttributes() || Globals::automaticRadiusEnabled || Globals::colorEnabled)
+        Globals::displayVAO->requestAttributes();
+
+    Globals::displayVAO->updateAttributes();
+}
+
+
+void Renderer::updateLightPosition()
+{
+    vector<Light*> lightList = Globals::sceneLightsList[ Globals::sceneLightsArrIndex % Globals::sceneLightsList.size()];
+
+    for (unsigned int i =0; i < lightList.size(); i++)
+        lightList[i]->update();
+
+    Light::pushToGPU(lightList);
+}
+
+
+
+void Renderer::applyFXAA(int windowWidth, int windowHeight)
+{
+
+    //fxaaFilter.compileShader();
+    Globals::fxaaFilter->bindShader();
+
+    //Copy framebuffer to a Texture
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, Globals::textureID);
+    glEnable(GL_TEXTURE_RECTANGLE);
+    //Allocated at the framebuffer size, so frames rendered smaller reuse it
+    if (Globals::firstTime){
+        glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, framebufferWidth, framebufferHeight, 0, GL_RGBA, GL_FLOAT, 0);
+        Globals::firstTime = false;
+    }
+    glCopyTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 0, 0, windowWidth, windowHeight);
+
+    glUniform1i(Shader::shaderInUse->renderTextureLoc, 0);
+    glUniform3f(Shader::shaderInUse->inverseTextureSizeLoc, 1.0f/windowWidth, 1.0f/windowHeight, 0.0f);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    drawWindowSizedRectangle();
+
+    glBindVertexArray(0);
+
+}
+
+
+
+/**
+ @returns true if the selected shader draws plain points: a single pass one
+ that reads no normals, which the screen space passes apply to
+ */
+bool Renderer::pointShaderActive()
+{
+    return !Globals::MultipassEnabled &&
+           !Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].readsSurfaceAttributes();
+}
+
+
+bool Renderer::edlActive()
+{
+    return Globals::edlEnabled && pointShaderActive();
+}
+
+
+bool Renderer::pullPushActive()
+{
+    return Globals::pullPushEnabled && pointShaderActive();
+}
+
+
+/**
+ @brief Shades the image in the framebuffer from its depth alone: each pixel is
+ darkened by how far it lies behind its neighbours, in log depth, and the
+ background around the cloud is outlined
+ @param windowWidth, windowHeight size of the framebuffer
+ */
+void Renderer::applyEDL(int windowWidth, int windowHeight)
+{
+    Globals::edlShader->bindShader();
+
+    //Copied, so the pass does not sample the depth buffer it is bound to
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_RECTANGLE, depthCopyTex);
+    glCopyTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 0, 0, windowWidth, windowHeight);
+    glUniform1i(Shader::shaderInUse->depthTextureLoc, 1);
+
+    //The shade multiplies the color already rendered
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+    drawWindowSizedRectangle();
+
+    glBlendFuncSeparateEXT(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+
+//Rectangle texture sampled texel by texel
+static GLuint screenTexture(GLint internalFormat, GLenum format, int width, int height)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_RECTANGLE, texture);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, internalFormat, width, height, 0, format, GL_FLOAT, 0);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+
+//Framebuffer writing color to attachment 0 and eye depth to attachment 1
+static GLuint pyramidFramebuffer(GLuint colorTex, GLuint depthTex)
+{
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTex, 0);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, depthTex, 0);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        exit(1);
+
+    return framebuffer;
+}
+
+
+/**
+ @brief Builds the pull-push pyramid of a framebuffer, halving its size at each level
+ @param width, height size of the framebuffer
+ */
+void Renderer::buildPyramid(int width, int height)
+{
+    releasePyramid();
+
+    colorCopyTex = screenTexture(GL_RGB8, GL_RGB, width, height);
+
+    for (int i = 0; i < PULL_PUSH_LEVELS && (width > 1 || height > 1); i++) {
+        pyramidLevel level;
+        level.width = width = (width + 1) / 2;
+        level.height = height = (height + 1) / 2;
+
+        level.pullColorTex = screenTexture(GL_RGBA16F, GL_RGBA, level.width, level.height);
+        level.pullDepthTex = screenTexture(GL_R32F, GL_RED, level.width, level.height);
+        level.pullFramebuffer = pyramidFramebuffer(level.pullColorTex, level.pullDepthTex);
+
+        level.pushColorTex = screenTexture(GL_RGBA16F, GL_RGBA, level.width, level.height);
+        level.pushDepthTex = screenTexture(GL_R32F, GL_RED, level.width, level.height);
+        level.pushFramebuffer = pyramidFramebuffer(level.pushColorTex, level.pushDepthTex);
+
+        pyramid.push_back(level);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+}
+
+
+void Renderer::releasePyramid()
+{
+    if (pyramidWidth == 0)
+        return;
+
+    glDeleteTextures(1, &colorCopyTex);
+    for (unsigned int i = 0; i < pyramid.size(); i++) {
+        GLuint textures[4] = {pyramid[i].pullColorTex, pyramid[i].pullDepthTex, pyramid[i].pushColorTex, pyramid[i].pushDepthTex};
+        GLuint framebuffers[2] = {pyramid[i].pullFramebuffer, pyramid[i].pushFramebuffer};
+        glDeleteTextures(4, textures);
+        glDeleteFramebuffers(2, framebuffers);
+    }
+    pyramid.clear();
+    pyramidWidth = pyramidHeight = 0;
+}
+
+
+/**
+ @brief Fills the gaps between the points in the framebuffer, in screen space.
+ Pull: each level averages the covered pixels of the finer one on the nearest
+ surface. Push: from the coarsest level down, each level fills what it lacks
+ from the coarser one, and drops the samples seen through a gap. The result
+ is written back with its depth; pixels not covered enough stay background.
+ @param windowWidth, windowHeight size of the frame, at most the framebuffer's
+ */
+void Renderer::applyPullPush(int windowWidth, int windowHeight)
+{
+    //Allocated at the framebuffer size, frames rendered smaller use the lower left of each level
+    if (framebufferWidth != pyramidWidth || framebufferHeight != pyramidHeight) {
+        buildPyramid(framebufferWidth, framebufferHeight);
+        pyramidWidth = framebufferWidth;
+        pyramidHeight = framebufferHeight;
+    }
+    if (pyramid.empty())
+        return;
+
+    vector<glm::ivec2> levelSize(pyramid.size() + 1);
+    levelSize[0] = glm::ivec2(windowWidth, windowHeight);
+    for (unsigned int i = 1; i < levelSize.size(); i++)
+        levelSize[i] = (levelSize[i - 1] + 1) / 2;
+
+    //Level 0, copied so the passes do not sample the framebuffer they are bound to
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_RECTANGLE, colorCopyTex);
+    glCopyTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 0, 0, windowWidth, windowHeight);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_RECTANGLE, depthCopyTex);
+    glCopyTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, 0, 0, windowWidth, windowHeight);
+
+    glDisable(GL_DEPTH_TEST);
+    GLenum attach[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+
+    //Pull
+    Globals::pullShader->bindShader();
+    glUniform1i(Shader::shaderInUse->renderTextureLoc, 0);
+    glUniform1i(Shader::shaderInUse->depthTextureLoc, 1);
+
+    for (unsigned int i = 0; i < pyramid.size(); i++) {
+        glUniform1i(Shader::shaderInUse->firstLevelLoc, (i == 0)?1:0);
+        glUniform2i(Shader::shaderInUse->levelSizeLoc, levelSize[i].x, levelSize[i].y);
+        if (i > 0) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_RECTANGLE, pyramid[i - 1].pullColorTex);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_RECTANGLE, pyramid[i - 1].pullDepthTex);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, pyramid[i].pullFramebuffer);
+        glDrawBuffers(2, attach);
+        glViewport(0, 0, levelSize[i + 1].x, levelSize[i + 1].y);
+        drawWindowSizedRectangle();
+    }
+
+    //Push, the coarsest level is already full
+    Globals::pushShader->bindShader();
+    glUniform1i(Shader::shaderInUse->renderTextureLoc, 0);
+    glUniform1i(Shader::shaderInUse->depthTextureLoc, 1);
+    glUniform1i(Shader::shaderInUse->coarseTextureLoc, 2);
+    glUniform1i(Shader::shaderInUse->coarseDepthTextureLoc, 3);
+
+    for (int i = (int) pyramid.size() - 2; i >= -1; i--) {
+        const pyramidLevel &coarse = pyramid[i + 1];
+        bool coarsest = (i + 2 == (int) pyramid.size());
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_RECTANGLE, coarsest ? coarse.pullColorTex : coarse.pushColorTex);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_RECTANGLE, coarsest ? coarse.pullDepthTex : coarse.pushDepthTex);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_RECTANGLE, (i >= 0) ? pyramid[i].pullColorTex : colorCopyTex);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_RECTANGLE, (i >= 0) ? pyramid[i].pullDepthTex : depthCopyTex);
+        glUniform1i(Shader::shaderInUse->firstLevelLoc, (i < 0)?1:0);
+        glUniform2i(Shader::shaderInUse->levelSizeLoc, levelSize[i + 2].x, levelSize[i + 2].y);
+
+        if (i >= 0) {
+            glBindFramebuffer(GL_FRAMEBUFFER, pyramid[i].pushFramebuffer);
+            glDrawBuffers(2, attach);
+            glViewport(0, 0, levelSize[i + 1].x, levelSize[i + 1].y);
+        }
+        else {
+            //Level 0 goes back to the framebuffer, depth included
+            glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0);
+            glViewport(0, 0, windowWidth, windowHeight);
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_ALWAYS);
+        }
+        drawWindowSizedRectangle();
+    }
+
+    glDepthFunc(GL_LEQUAL);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+
+/**
+ @brief Renders the displayed model with the selected shader into the offscreen framebuffer
+ @param windowWidth, windowHeight size of the framebuffer
+ */
+void Renderer::render(int windowWidth, int windowHeight)
+{
+    if (Globals::displayVAO != NULL) {
+    updateAttributes();
+    glBindVertexArray(Globals::displayVAO->getVAOid());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glViewport(0, 0, windowWidth, windowHeight);
+
+    //Organized clouds can be drawn as their range image mesh, a single pass without splats
+    if (Globals::rangeMeshEnabled && Globals::displayVAO->hasMesh())
+        drawRangeMesh();
+    else if (Globals::displayVAO != NULL) {
+
+        //Transform & cull once, every splat pass of this frame reads the result
+        if (Globals::splatCacheEnabled && Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].acceptsCachedInput()) {
+            Profiler::beginPass("Splat Cache");
+            Globals::splatCache->capture(Globals::displayVAO);
+            Profiler::endPass();
+        }
+
+        if (!Globals::MultipassEnabled) {
+            Profiler::beginPass(passName(SINGLEPASS));
+            Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()].bindShader();
+
+            glClearColor(86.f/255.f,136.f/255.f,199.f/255.f,1.0f);
+            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glDepthFunc(GL_LEQUAL);
+            drawSplats();
+            Profiler::endPass();
+
+            if (pullPushActive()) {
+                Profiler::beginPass("Pull-Push");
+                applyPullPush(windowWidth, windowHeight);
+                Profiler::endPass();
+            }
+
+            if (edlActive()) {
+                Profiler::beginPass("Eye-Dome Lighting");
+                applyEDL(windowWidth, windowHeight);
+                Profiler::endPass();
+            }
+        }
+        else {
+            glDepthMask(GL_TRUE);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            Shader shaderh = Globals::listOfShaders[Globals::actualShader%Globals::listOfShaders.size()];
+            unsigned int indexMultipass = Globals::actualMultipass % shaderh.getMultiPass().size();
+
+            for (unsigned int i = 0; i < shaderh.getMultiPass(indexMultipass).size(); i++) {
+
+                Profiler::beginPass(passName(shaderh.getMultiPass(indexMultipass)[i].getMode()));
+                shaderh.getMultiPass(indexMultipass)[i].bindShader();
+
+                switch (shaderh.getMultiPass(indexMultipass)[i].getMode()) {
+
+                    case shader::DEPTH_MASK:
+                    {
+                        glDepthMask(GL_TRUE);
+                        GLenum attach[2] = {GL_NONE, GL_COLOR_ATTACHMENT3};
+                        glDrawBuffers(2, attach);
+                        drawSplats();
+                        break;
+                    }
+                    case shader::BLENDING:
+                    {
+                        glEnable(GL_BLEND);
+                        glDepthMask(GL_FALSE);
+                        glDepthFunc(GL_LEQUAL);
+                        GLenum attach[2] = {GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+                        glDrawBuffers(2, attach);
+                        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                        glClear(GL_COLOR_BUFFER_BIT);
+                        drawSplats();
+                        break;
+                    }
+                    case shader::TILE_REPROJECTION:
+                    {
+                        //Nearest depth & depth window of each tile: the tiles of the previous
+                        //frame moved to this view, one point each, kept with GL_MIN. Tiles no
+                        //point lands on stay at the far plane, so every splat there weighs 1
+                        glm::mat4 reprojection = Camera::projMatrix * Camera::viewMatrix
+                                               * glm::inverse(previousViewMatrix) * glm::inverse(previousProjMatrix);
+                        glUniformMatrix4fv(Shader::shaderInUse->reprojectionMatrixLoc, 1, false, &reprojection[0][0]);
+                        glUniformMatrix4fv(Shader::shaderInUse->previousProjMatrixLoc, 1, false, &previousProjMatrix[0][0]);
+                        glUniform2i(Shader::shaderInUse->previousSizeLoc, previousWidth, previousHeight);
+                        glUniform1i(Shader::shaderInUse->tileSizeLoc, TILE_SIZE);
+
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, tileHistoryTex);
+                        glUniform1i(Shader::shaderInUse->tileHistoryTextureLoc, 0);
+
+                        glBindFramebuffer(GL_FRAMEBUFFER, tileFramebufferName);
+                        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+                        glViewport(0, 0, (windowWidth + TILE_SIZE - 1)/TILE_SIZE, (windowHeight + TILE_SIZE - 1)/TILE_SIZE);
+                        GLfloat farDepth[4] = {Camera::f, Camera::f, Camera::f, 1.0f};
+                        glClearBufferfv(GL_COLOR, 0, farDepth);
+
+                        glEnable(GL_BLEND);
+                        glBlendEquation(GL_MIN);
+                        glDisable(GL_DEPTH_TEST);
+                        glBindVertexArray(tileVAO);
+                        glDrawArrays(GL_POINTS, 0, ((previousWidth + TILE_SIZE - 1)/TILE_SIZE) * ((previousHeight + TILE_SIZE - 1)/TILE_SIZE));
+                        glBindVertexArray(0);
+                        glBlendEquation(GL_FUNC_ADD);
+                        glEnable(GL_DEPTH_TEST);
+
+                        glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+                        glViewport(0, 0, windowWidth, windowHeight);
+                        break;
+                    }
+                    case shader::WEIGHTED_BLENDING:
+                    {
+                        //Single splat pass: no visibility mask, splats behind the
+                        //nearest depth of their tile fade out. The nearest depth of
+                        //each pixel is kept with GL_MIN for the next frame
+                        glEnable(GL_BLEND);
+                        glBlendEquationi(1, GL_MIN);
+                        glDisable(GL_DEPTH_TEST);
+                        glDepthMask(GL_FALSE);
+                        GLenum attach[2] = {GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT3};
+                        glDrawBuffers(2, attach);
+                        GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                        GLfloat farDepth[4] = {Camera::f, Camera::f, Camera::f, 1.0f};
+                        glClearBufferfv(GL_COLOR, 0, zero);
+                        glClearBufferfv(GL_COLOR, 1, farDepth);
+
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, tileDepthTex);
+                        glUniform1i(Shader::shaderInUse->tileDepthTextureLoc, 0);
+                        glUniform1i(Shader::shaderInUse->tileSizeLoc, TILE_SIZE);
+
+                        drawSplats();
+
+                        glBlendEquationi(1, GL_FUNC_ADD);
+                        glEnable(GL_DEPTH_TEST);
+                        break;
+                    }
+                    case shader::TILE_DEPTH:
+                    {
+                        //Nearest depth & depth window of each tile in this frame, reduced
+                        //from the depths of its pixels, reprojected by the next frame
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
+                        glUniform1i(Shader::shaderInUse->positionTextureLoc, 0);
+                        glUniform1i(Shader::shaderInUse->tileSizeLoc, TILE_SIZE);
+                        glUniform1f(Shader::shaderInUse->depthWindowLoc, DEPTH_WINDOW);
+                        glUniform1f(Shader::shaderInUse->depthRangeLoc, DEPTH_RANGE);
+
+                        glBindFramebuffer(GL_FRAMEBUFFER, tileFramebufferName);
+                        glDrawBuffer(GL_COLOR_ATTACHMENT1);
+                        glViewport(0, 0, (windowWidth + TILE_SIZE - 1)/TILE_SIZE, (windowHeight + TILE_SIZE - 1)/TILE_SIZE);
+                        drawWindowSizedRectangle();
+
+                        glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+                        glViewport(0, 0, windowWidth, windowHeight);
+
+                        previousViewMatrix = Camera::viewMatrix;
+                        previousProjMatrix = Camera::projMatrix;
+                        previousWidth = windowWidth;
+                        previousHeight = windowHeight;
+                        break;
+                    }
+                    case shader::NORMALIZATION:
+                    {
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
+                        glUniform1i(Shader::shaderInUse->blendTextureLoc, 0);
+
+                        glActiveTexture(GL_TEXTURE1);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
+                        glUniform1i(Shader::shaderInUse->normalTextureLoc, 1);
+
+                        glActiveTexture(GL_TEXTURE2);
+                        glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
+                        glUniform1i(Shader::shaderInUse->positionTextureLoc, 2);
+
+                        //Render Texture and normalize
+                        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+                        glClearColor(86.f/255.f,136.f/255.f,199.f/255.f,1.0f);
+                        glClear(GL_COLOR_BUFFER_BIT);
+                        drawWindowSizedRectangle();
+                        break;
+                    }
+                    default:
+                        break;
+                }
+
+                glDisable(GL_BLEND);
+                glDepthMask(GL_TRUE);
+                Profiler::endPass();
+            }
+
+        }
+    }
+
+    glBindVertexArray(0);
+
+    if (Globals::FXAA) {
+        Profiler::beginPass("FXAA");
+        applyFXAA(windowWidth, windowHeight);
+        Profiler::endPass();
+    }
+
+    }
+}
+
+
+/**
+ @brief Copies the offscreen framebuffer to the default one, upscaling it
+ when the frame was rendered below the window size
+ @param renderWidth, renderHeight size of the rendered image
+ @param windowWidth, windowHeight size of the window
+ */
+void Renderer::present(int renderWidth, int renderHeight, int windowWidth, int windowHeight)
+{
+    //Blit framebuffer resultant to window
+    Profiler::beginPass("Blit");
+    bool scaled = (renderWidth != windowWidth || renderHeight != windowHeight);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferName);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderWidth, renderHeight,
+                      0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+    Profiler::endPass();
+}
+
+
+/**
+ @brief Reads the last rendered image, bottom row first
+ @param width, height size of the framebuffer
+ @param pixels RGB bytes
+ */
+void Renderer::readPixels(int width, int height, vector<unsigned char> &pixels)
+{
+    pixels.resize(width * height * 3);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferName);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+
+void Renderer::buildFBO(int width, int height)
+{
+    framebufferWidth = width;
+    framebufferHeight = height;
+
+    // ---------------------------------------------
+    // Render to Texture - specific code begins here
+    // ---------------------------------------------
+
+    // The framebuffer, which regroups 0, 1, or more textures, and 0 or 1 depth buffer.
+    glGenFramebuffers(1, &FramebufferName);
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferName);
+
+    // The texture we're going to render to
+    // The texture we're going to render to
+    glGenTextures(4, fbufferTex);
+
+    // "Bind" the newly created texture : all future texture functions will modify this texture
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[0]);
+
+    // Give an empty image to OpenGL ( the last "0" means "empty" )
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+
+    // Poor filtering
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+
+    // "Bind" the newly created texture : all future texture functions will modify this texture
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[1]);
+
+    // Give an empty image to OpenGL ( the last "0" means "empty" )
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, 0);
+
+    // Poor filtering
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+
+    // "Bind" the newly created texture : all future texture functions will modify this texture
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[2]);
+    // Give an empty image to OpenGL ( the last "0" means "empty" )
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, 0);
+    // Poor filtering
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+
+    //// Alternative : Depth texture. Slower, but you can sample it later in your shader
+    glBindTexture(GL_TEXTURE_RECTANGLE, fbufferTex[3]);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // The depth buffer
+    glGenRenderbuffers(1, &depthrenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthrenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthrenderbuffer);
+
+    //Copy of the depth buffer read by the screen space passes
+    glGenTextures(1, &depthCopyTex);
+    glBindTexture(GL_TEXTURE_RECTANGLE, depthCopyTex);
+    glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+    // Set "renderedTexture" as our colour attachement #0
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, fbufferTex[0], 0);
+
+
+    // Set "blendTexture" as our colour attachement #0
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, fbufferTex[1], 0);
+
+    // Set "normalsTexture" as our colour attachement #0
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, fbufferTex[2], 0);
+
+    //// Depth texture alternative :
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, fbufferTex[3], 0);
+
+
+    // Set the list of draw buffers.
+
+    // Always check that our framebuffer is ok
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        exit(1);
+
+    //Per tile nearest depth & depth window: reprojected for the weighted blending pass (0)
+    //and reduced after it for the next frame (1)
+    glGenFramebuffers(1, &tileFramebufferName);
+    glBindFramebuffer(GL_FRAMEBUFFER, tileFramebufferName);
+
+    GLuint *tileTex[2] = {&tileDepthTex, &tileHistoryTex};
+    for (int i = 0; i < 2; i++) {
+        glGenTextures(1, tileTex[i]);
+        glBindTexture(GL_TEXTURE_RECTANGLE, *tileTex[i]);
+        glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RG32F, (width + TILE_SIZE - 1)/TILE_SIZE, (height + TILE_SIZE - 1)/TILE_SIZE, 0, GL_RG, GL_FLOAT, 0);
+        glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, *tileTex[i], 0);
+    }
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        exit(1);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &tileVAO);
+
+    //Window sized rectangle of the screen space passes, two triangles
+    float points[] = {
+        -1.0f, -1.0f, 0.0f,
+        1.0f, -1.0f, 0.0f,
+        -1.0f,  1.0f, 0.0f,
+        -1.0f,  1.0f, 0.0f,
+        1.0f, -1.0f, 0.0f,
+        1.0f,  1.0f, 0.0f,
+    };
+
+    glGenBuffers(1, &quadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &quadVAO);
+    glBindVertexArray(quadVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glBindVertexArray(0);
+}
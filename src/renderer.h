@@ -0,0 +1,109 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__renderer__
+#define __CUBE__renderer__
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.h"
+
+#define TILE_SIZE 8                //side in pixels of the tiles used to estimate the local depth window
+#define DEPTH_WINDOW (1.0f/40.0f)  //narrowest depth window of a tile, same order as the depth offset of the two pass blending
+#define DEPTH_RANGE (8.0f*DEPTH_WINDOW) //depth behind the nearest pixel of a tile still taken as its surface
+#define PULL_PUSH_LEVELS 5         //coarser levels of the hole filling pyramid, fills gaps up to 2^5 pixels wide
+
+using namespace std;
+
+//Level of the pull-push pyramid: color premultiplied by its weight & eye depth,
+//pulled from the finer level and pushed back after filling
+struct pyramidLevel {
+    int width, height;
+    GLuint pullFramebuffer, pullColorTex, pullDepthTex;
+    GLuint pushFramebuffer, pushColorTex, pushDepthTex;
+};
+
+/**
+ @brief Window independent part of CUBE: offscreen framebuffer and passes of
+ every shader. Renders Globals::displayVAO with the shader selected in Globals.
+ Shared by the viewer and the headless renderer.
+ */
+class Renderer {
+
+private:
+    Renderer();
+
+    static int framebufferWidth, framebufferHeight; //allocated size of the offscreen targets, frames may use less
+    static GLuint FramebufferName;
+    static GLuint fbufferTex[4];
+    static GLuint depthrenderbuffer;
+    static GLuint tileFramebufferName;
+    static GLuint tileDepthTex;     //nearest depth & depth window of each tile, reprojected from the previous frame
+    static GLuint tileHistoryTex;   //nearest depth & depth window of each tile in the last frame rendered
+    static GLuint tileVAO;          //no attributes, the tile points are indexed by gl_VertexID
+    static GLuint quadVAO, quadVBO; //window sized rectangle, built once with the framebuffer
+    static glm::mat4 previousViewMatrix, previousProjMatrix;
+    static int previousWidth, previousHeight; //size of the last frame with tile depths, 0 if none
+    static GLuint depthCopyTex;
+    static GLuint colorCopyTex;
+    static vector<pyramidLevel> pyramid;   //levels 1 to PULL_PUSH_LEVELS, level 0 is the framebuffer
+    static int pyramidWidth, pyramidHeight;
+
+    static void buildFBO(int width, int height);
+    static void drawWindowSizedRectangle();
+    static void drawSplats();
+    static void drawRangeMesh();
+    static void updateAttributes();
+    static void applyFXAA(int windowWidth, int windowHeight);
+    static void applyEDL(int windowWidth, int windowHeight);
+    static void buildPyramid(int width, int height);
+    static void releasePyramid();
+    static void applyPullPush(int windowWidth, int windowHeight);
+
+public:
+    static bool init(int width, int height);
+    static void resize(int w, int h);
+
+    static void updateLightPosition();
+    static void render(int windowWidth, int windowHeight);
+    static void present(int renderWidth, int renderHeight, int windowWidth, int windowHeight);
+    static void readPixels(int width, int height, vector<unsigned char> &pixels);
+
+    static string passName(shaderMode mode);
+    static bool pointShaderActive();
+    static bool edlActive();
+    static bool pullPushActive();
+
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "residency.h"
+
+#include "globals.h"
+
+size_t Residency::budget = 0;
+unsigned long Residency::clock = 0;
+vector<unsigned long> Residency::lastUse;
+
+
+size_t Residency::residentBytes()
+{
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < Globals::models.size(); i++)
+        bytes += Globals::models[i].getGPUBytes();
+
+    return bytes;
+}
+
+
+/**
+ @returns true if bytes more can be uploaded within the budget and the free video memory
+ */
+bool Residency::fits(size_t bytes)
+{
+    if (budget > 0 && residentBytes() + bytes > budget)
+        return false;
+
+    int freeKB = VAO::getFreeVideoMemory();
+    if (freeKB >= 0 && (size_t) freeKB * 1024 < bytes + RESIDENCY_HEADROOM)
+        return false;
+
+    return true;
+}
+
+
+/**
+ @brief Releases the resident model used longest ago
+ @param keep model never evicted
+ @returns false if there is nothing left to evict
+ */
+bool Residency::evictLeastRecent(unsigned int keep)
+{
+    int victim = -1;
+    for (unsigned int i = 0; i < Globals::models.size(); i++) {
+        if (i == keep || !Globals::models[i].isResident())
+            continue;
+        if (victim < 0 || lastUse[i] < lastUse[victim])
+            victim = i;
+    }
+
+    if (victim < 0)
+        return false;
+
+    cout << "Evicting model " << victim << " from the GPU, "
+         << Globals::models[victim].getGPUBytes() / (1024*1024) << " MB." << endl;
+    Globals::models[victim].releaseGPU();
+
+    return true;
+}
+
+
+/**
+ @brief Makes a model resident before displaying it, evicting others if needed
+ @param model index in Globals::models
+ @returns the model
+ */
+VAO *Residency::use(unsigned int model)
+{
+    lastUse.resize(Globals::models.size(), 0);
+    lastUse[model] = ++clock;
+
+    VAO &vao = Globals::models[model];
+    if (!vao.isResident()) {
+        size_t bytes = (sizeof(vaoGeometry) + sizeof(vaoAppearance)) * vao.getNumOfVertices()
+                     + sizeof(uint32_t) * vao.getPoints().triangles.size();
+        while (!fits(bytes) && evictLeastRecent(model));
+        vao.pushToGPU();
+    }
+
+    return &vao;
+}
+
+
+/**
+ @brief Releases every model, before Globals::models is cleared
+ */
+void Residency::releaseAll()
+{
+    for (unsigned int i = 0; i < Globals::models.size(); i++)
+        Globals::models[i].releaseGPU();
+
+    lastUse.clear();
+}
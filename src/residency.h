@@ -0,0 +1,68 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__residency__
+#define __CUBE__residency__
+
+#include <iostream>
+#include <vector>
+
+#include "vao.h"
+
+#define RESIDENCY_HEADROOM (64*1024*1024) //bytes of measured free memory left for framebuffers & the driver
+
+using namespace std;
+
+/**
+ @brief Keeps the buffers of Globals::models on the GPU while they fit. The
+ least recently displayed models are evicted when a new one does not fit in
+ the budget or in the free video memory measured by VAO::getFreeVideoMemory,
+ and uploaded again from their host copy when they are displayed.
+ */
+class Residency {
+
+private:
+    Residency();
+
+    static size_t budget;
+    static unsigned long clock;
+    static vector<unsigned long> lastUse;   //per model, clock of its last use
+
+    static size_t residentBytes();
+    static bool fits(size_t bytes);
+    static bool evictLeastRecent(unsigned int keep);
+
+public:
+    static void setBudget(size_t bytes) { budget = bytes; };
+    static size_t getBudget() { return budget; };
+
+    static VAO *use(unsigned int model);
+    static void releaseAll();
+
+};
+
+#endif
@@ -0,0 +1,292 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "scene.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "file.h"
+#include "globals.h"
+#include "profiler.h"
+#include "progressive.h"
+
+
+Scene::Scene()
+{
+    instanceBufferID = 0;
+    poolSize = 0;
+    numOfVertices = 0;
+    numOfTriangles = 0;
+    mode = GL_POINTS;
+    initialized = false;
+    resident = false;
+}
+
+
+/**
+ @brief Reads a scene file. Each line is one of
+   model <path to .ply or .pcd>
+   instance <x> <y> <z> [<rotation around y in degrees> [<scale>]]
+ instances place the last model; blank lines and lines starting with # are skipped
+ @param path scene file
+ @returns false if the file can not be read or it has no instance
+ */
+bool Scene::load(string path)
+{
+    ifstream file(path.c_str());
+    if (!file.is_open()) {
+        cout << "Can not open scene " << path << endl;
+        return false;
+    }
+
+    int model = -1;
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string command;
+        if (!(fields >> command) || command[0] == '#')
+            continue;
+
+        if (command == "model") {
+            string modelPath;
+            fields >> modelPath;
+            model = addModel(modelPath);
+        }
+        else if (command == "instance" && model >= 0) {
+            float x = 0, y = 0, z = 0, angle = 0, scale = 1;
+            fields >> x >> y >> z;
+            if (fields >> angle)
+                fields >> scale;
+
+            glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z));
+            matrix = glm::rotate(matrix, glm::radians(angle), glm::vec3(0, 1, 0));
+            matrix = glm::scale(matrix, glm::vec3(scale));
+            addInstance(model, matrix);
+        }
+        else
+            cout << "Scene: skipped line \"" << line << "\"" << endl;
+    }
+
+    initialized = getNumOfInstances() > 0;
+    return initialized;
+}
+
+
+/**
+ @brief Loads a cloud and appends it to the pool
+ @param path cloud file
+ @returns index of the model, -1 if it can not be loaded
+ */
+int Scene::addModel(string path)
+{
+    VAO cloud = loadCloud(path, Globals::pointBudget);
+    if (!cloud.isValid())
+        return -1;
+
+    vector<vaoGeometry> geometry;
+    vector<vaoAppearance> appearance;
+    cloud.computeAttributes();
+    cloud.packVertices(geometry, appearance);
+
+    sceneModel model;
+    model.path = path;
+    model.first = geometryData.size();
+    model.count = geometry.size();
+    model.firstInstance = 0;
+    models.push_back(model);
+
+    geometryData.insert(geometryData.end(), geometry.begin(), geometry.end());
+    appearanceData.insert(appearanceData.end(), appearance.begin(), appearance.end());
+    poolSize = geometryData.size();
+
+    return models.size() - 1;
+}
+
+
+void Scene::addInstance(int model, glm::mat4 matrix)
+{
+    models[model].instances.push_back(matrix);
+    numOfVertices += models[model].count;
+}
+
+
+size_t Scene::getNumOfInstances()
+{
+    size_t instances = 0;
+    for (unsigned int i = 0; i < models.size(); i++)
+        instances += models[i].instances.size();
+
+    return instances;
+}
+
+
+/**
+ @brief Uploads the pool, one pair of buffers per chunk as VAO::pushToGPU, and
+ the instance matrices, grouped by model
+ */
+void Scene::pushToGPU()
+{
+    if (resident || poolSize == 0)
+        return;
+
+    vector<glm::mat4> matrices;
+    for (unsigned int i = 0; i < models.size(); i++) {
+        models[i].firstInstance = matrices.size();
+        matrices.insert(matrices.end(), models[i].instances.begin(), models[i].instances.end());
+    }
+
+    glGenVertexArrays(1, &vaoID);
+    glBindVertexArray(vaoID);
+
+    size_t numOfVBO = numOfVBORequired(poolSize);
+    vboID.resize(numOfVBO);
+    appearanceVboID.resize(numOfVBO);
+    glGenBuffers((GLsizei) numOfVBO, &vboID[0]);
+    glGenBuffers((GLsizei) numOfVBO, &appearanceVboID[0]);
+
+    for (size_t i = 0; i < numOfVBO; i++) {
+        size_t first = maxNumOfVertexByVBO() * i;
+        size_t count = numOfVertexByVBO(poolSize, i);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vboID[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (sizeof(vaoGeometry) * count), &geometryData[first], GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, appearanceVboID[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (sizeof(vaoAppearance) * count), &appearanceData[first], GL_STATIC_DRAW);
+    }
+
+    glGenBuffers(1, &instanceBufferID);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBufferID);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * matrices.size(), matrices.empty() ? NULL : &matrices[0], GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    for (int column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(MODEL_MATRIX_LOCATION + column);
+        glVertexAttribDivisor(MODEL_MATRIX_LOCATION + column, 1);
+    }
+
+    cout << "Scene: " << models.size() << " models, " << matrices.size() << " instances, "
+         << (sizeof(vaoGeometry) + sizeof(vaoAppearance)) * poolSize << " bytes in " << numOfVBO << " buffers." << endl;
+
+    resident = true;
+}
+
+
+void Scene::releaseGPU()
+{
+    if (!resident)
+        return;
+
+    glDeleteBuffers((GLsizei) vboID.size(), &vboID[0]);
+    glDeleteBuffers((GLsizei) appearanceVboID.size(), &appearanceVboID[0]);
+    vboID.clear();
+    appearanceVboID.clear();
+    glDeleteBuffers(1, &instanceBufferID);
+    glDeleteVertexArrays(1, &vaoID);
+    resident = false;
+}
+
+
+size_t Scene::getGPUBytes()
+{
+    if (!resident)
+        return 0;
+
+    return (sizeof(vaoGeometry) + sizeof(vaoAppearance)) * poolSize + sizeof(glm::mat4) * getNumOfInstances();
+}
+
+
+/**
+ @brief One instanced draw per model and buffer it overlaps: attribute
+ offsets move along the buffer, so vertex indices stay small whatever its size
+ @param streams vertex streams read by the shader in use
+ */
+void Scene::draw(vertexStream streams)
+{
+    if (streams & APPEARANCE_STREAM)
+        glEnableVertexAttribArray(1);
+    else
+        glDisableVertexAttribArray(1);
+
+    size_t stride = Progressive::getStride();
+
+    for (unsigned int m = 0; m < models.size(); m++) {
+        sceneModel &model = models[m];
+        if (model.instances.empty())
+            continue;
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBufferID);
+        for (int column = 0; column < 4; column++)
+            glVertexAttribPointer(MODEL_MATRIX_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  BUFFER_OFFSET(sizeof(glm::mat4) * model.firstInstance + sizeof(glm::vec4) * column));
+
+        //One draw per chunk the model overlaps, from its first vertex in that chunk
+        size_t end = model.first + model.count;
+        for (size_t vertex = model.first; vertex < end; ) {
+            size_t chunk = vertex / maxNumOfVertexByVBO();
+            size_t offset = vertex - chunk * maxNumOfVertexByVBO();
+            size_t count = min(maxNumOfVertexByVBO() - offset, end - vertex);
+            vertex += count;
+
+            //Every stride-th point of the chunk while Progressive refines the view
+            count = (count + stride - 1) / stride;
+            GLsizei geometryStride = (GLsizei) (sizeof(vaoGeometry) * stride);
+
+            glBindBuffer(GL_ARRAY_BUFFER, vboID[chunk]);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(sizeof(vaoGeometry) * offset));
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(sizeof(vaoGeometry) * offset + sizeof(glm::vec3)));
+            glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(sizeof(vaoGeometry) * offset + sizeof(glm::vec3)*2));
+
+            if (streams & APPEARANCE_STREAM) {
+                glBindBuffer(GL_ARRAY_BUFFER, appearanceVboID[chunk]);
+                glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, (GLsizei) (sizeof(vaoAppearance) * stride), BUFFER_OFFSET(sizeof(vaoAppearance) * offset));
+            }
+
+            glDrawArraysInstanced(mode, 0, (GLsizei) count, (GLsizei) model.instances.size());
+            Profiler::countDraw(count * model.instances.size());
+        }
+    }
+
+    resetModelMatrix();
+}
+
+
+/**
+ @brief Sets the identity as the current value of in_ModelMatrix, read by every
+ model drawn without the per instance attribute
+ */
+void Scene::resetModelMatrix()
+{
+    for (int column = 0; column < 4; column++)
+        glVertexAttrib4f(MODEL_MATRIX_LOCATION + column, column == 0, column == 1, column == 2, column == 3);
+}
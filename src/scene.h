@@ -0,0 +1,87 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__scene__
+#define __CUBE__scene__
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "vao.h"
+
+#define MODEL_MATRIX_LOCATION 5 //in_ModelMatrix, one attribute per column
+
+using namespace std;
+
+//Range of the pool holding a model, and its instances
+struct sceneModel {
+    string path;
+    size_t first;                   //first vertex in the pool
+    size_t count;
+    size_t firstInstance;           //first matrix in the instance buffer
+    vector<glm::mat4> instances;
+};
+
+/**
+ @brief Several clouds, each placed any number of times with its own model
+ matrix. Every model is packed in one shared pool, uploaded in chunks of
+ MAX_VBO_SIZE like any VAO, and all the instances of a model are drawn with
+ instanced draws.
+ Displayed through Globals::displayVAO like any other model.
+ */
+class Scene : public VAO
+{
+
+private:
+    vector<sceneModel> models;
+    vector<vaoGeometry> geometryData;       //host pool, kept so it can be uploaded again
+    vector<vaoAppearance> appearanceData;
+    GLuint instanceBufferID;
+    size_t poolSize;
+
+public:
+    Scene();
+
+    bool load(string path);
+    int addModel(string path);
+    void addInstance(int model, glm::mat4 matrix);
+    size_t getNumOfInstances();
+
+    void pushToGPU();
+    void releaseGPU();
+    void draw(vertexStream streams = ALL_STREAMS);
+    size_t getGPUBytes();
+
+    static void resetModelMatrix();
+
+};
+
+#endif
@@ -33,6 +33,7 @@
 
 #include "orbitallight.h"
 #include "camera.h"
+#include "progressive.h"
 
 Shader* Shader::shaderInUse = NULL;
 
@@ -43,6 +44,8 @@ Shader::Shader(string description, string vertexShaderPath, string fragmentShade
     this->vertexShaderPath = vertexShaderPath;
     this->fragmentShaderPath = fragmentShaderPath;
     this->mode = mode;
+    this->cachedInput = false;
+    this->surfaceAttributes = true;
 }
 
 
@@ -52,6 +55,8 @@ Shader::Shader(string description, string vertexShaderPath, string fragmentShade
     this->vertexShaderPath = vertexShaderPath;
     this->fragmentShaderPath = fragmentShaderPath;
     this->mode = mode;
+    this->cachedInput = false;
+    this->surfaceAttributes = true;
     this->multiPass.push_back( multiPass);
 }
 
@@ -64,9 +69,37 @@ Shader::Shader(string description, string vertexShaderPath,
     this->vertexShaderPath = vertexShaderPath;
     this->fragmentShaderPath = fragmentShaderPath;
     this->mode = mode;
+    this->cachedInput = false;
+    this->surfaceAttributes = true;
     this->multiPass = multiPass;
 }
 
+/**
+ @brief Sets an alternative vertex & geometry shader pair which rasterizes each
+ splat as the projection of the square circumscribing its disc, instead of a
+ screen-aligned point sprite. Used when Globals::tightBoundsEnabled is set.
+ @param vertexShaderPath vertex shader feeding the geometry shader
+ @param geometryShaderPath geometry shader emitting the bounding quad
+ */
+void Shader::setBoundingGeometry(string vertexShaderPath, string geometryShaderPath)
+{
+    this->boundsVertexShaderPath = vertexShaderPath;
+    this->boundsGeometryShaderPath = geometryShaderPath;
+}
+
+/**
+ @brief Turns the shader into a capture program: the vertex shader output goes
+ through a geometry shader and is written to a buffer with transform feedback,
+ in interleaved mode, instead of being rasterized. No fragment shader is used.
+ @param geometryShaderPath geometry shader whose outputs are captured
+ @param varyings names of the captured outputs, in buffer order
+ */
+void Shader::setFeedback(string geometryShaderPath, vector<string> varyings)
+{
+    this->geometryShaderPath = geometryShaderPath;
+    this->feedbackVaryings = varyings;
+}
+
 /**
  @brief Display (hopefully) useful error messages if shader fails to compile
  From OpenGL Shading Language 3rd Edition, p215-216
@@ -101,13 +134,30 @@ void Shader::bindShader()
 {
     program = glCreateProgram();
     
-    glAttachShader(program, v);
-    glAttachShader(program, f);
+    if (hasFeedback()) {
+        glAttachShader(program, v);
+        glAttachShader(program, g);
+
+        vector<const char*> varyings;
+        for (unsigned int i = 0; i < feedbackVaryings.size(); i++)
+            varyings.push_back(feedbackVaryings[i].c_str());
+        glTransformFeedbackVaryings(program, varyings.size(), &varyings[0], GL_INTERLEAVED_ATTRIBS);
+    }
+    else {
+        if (Globals::tightBoundsEnabled && hasBoundingGeometry()) {
+            glAttachShader(program, bv);
+            glAttachShader(program, bg);
+        }
+        else
+            glAttachShader(program, v);
+        glAttachShader(program, f);
+    }
     
     glBindAttribLocation(program, 0, "in_Position");
     glBindAttribLocation(program, 1, "in_Color");
     glBindAttribLocation(program, 2, "in_Normals");
     glBindAttribLocation(program, 3, "in_Radius");
+    glBindAttribLocation(program, 5, "in_ModelMatrix");    //5 to 8, one column each
     
     glLinkProgram(program);
     
@@ -141,10 +191,24 @@ void Shader::bindShader()
     blendTextureLoc = glGetUniformLocation(program, "blendTexture");
     normalTextureLoc = glGetUniformLocation(program, "normalTexture");
     positionTextureLoc = glGetUniformLocation(program, "positionTexture");
+    tileDepthTextureLoc = glGetUniformLocation(program, "tileDepthTexture");
+    tileHistoryTextureLoc = glGetUniformLocation(program, "tileHistoryTexture");
+    reprojectionMatrixLoc = glGetUniformLocation(program, "reprojectionMatrix");
+    previousProjMatrixLoc = glGetUniformLocation(program, "previousProjMatrix");
+    previousSizeLoc = glGetUniformLocation(program, "previousSize");
+    depthTextureLoc = glGetUniformLocation(program, "depthTexture");
+    coarseTextureLoc = glGetUniformLocation(program, "coarseTexture");
+    coarseDepthTextureLoc = glGetUniformLocation(program, "coarseDepthTexture");
+    firstLevelLoc = glGetUniformLocation(program, "firstLevel");
+    levelSizeLoc = glGetUniformLocation(program, "levelSize");
+    tileSizeLoc = glGetUniformLocation(program, "tileSize");
+    depthWindowLoc = glGetUniformLocation(program, "depthWindow");
+    depthRangeLoc = glGetUniformLocation(program, "depthRange");
     
     inverseTextureSizeLoc = glGetUniformLocation(program, "inverseTextureSize");
     colorEnabledLoc = glGetUniformLocation(program, "colorEnabled");
     automaticRadiusEnabledLoc = glGetUniformLocation(program, "automaticRadiusEnabled");
+    cachedInputLoc = glGetUniformLocation(program, "cachedInput");
     
     //Lights
     glUniform3fv(lightPositionLoc, MAX_LIGHTS , OrbitalLight::lightPosition );
@@ -167,51 +231,69 @@ void Shader::bindShader()
     
     glUniform1f(automaticRadiusEnabledLoc, Globals::automaticRadiusEnabled);
     glUniform1f(colorEnabledLoc, Globals::colorEnabled);
-    glUniform1f(radiusSplatLoc, Globals::userRadiusFactor);
+    //Sparser subsets while the camera moves take larger splats to stay closed
+    glUniform1f(radiusSplatLoc, Globals::userRadiusFactor * Progressive::getRadiusScale());
+    glUniform1i(cachedInputLoc, (Globals::splatCacheEnabled && cachedInput)?1:0);
 }
 
 
 
-void Shader::compileShader()
+GLuint Shader::compileStage(GLenum type, string path)
 {
-    
-    char *vs,*fs;
-    
-    v = glCreateShader(GL_VERTEX_SHADER);
-    f = glCreateShader(GL_FRAGMENT_SHADER);
-    
-    // load shaders & get length of each
-    GLint vlen;
-    GLint flen;
-    
-    vs = loadFile( PATH_TO_SHADERS + vertexShaderPath, vlen);
-    fs = loadFile( PATH_TO_SHADERS + fragmentShaderPath, flen);
-    
-    const char * vv = vs;
-    const char * ff = fs;
-    
-    glShaderSource(v, 1, &vv, &vlen);
-    glShaderSource(f, 1, &ff, &flen);
-    
+    GLuint stage = glCreateShader(type);
+
+    // load shader & get its length
+    GLint len;
+    char *source = loadFile( PATH_TO_SHADERS + path, len);
+    string text(source, len);
+    delete [] source; // we allocated this in the loadFile function...
+
+    //Stages calling splatSetup get its shared source right after their #version line
+    string library;
+    size_t split = 0;
+    if (text.find("splatSetup(") != string::npos) {
+        GLint libraryLen;
+        char *librarySource = loadFile(string(PATH_TO_SHADERS) + SPLAT_SETUP_SHADER, libraryLen);
+        library.assign(librarySource, libraryLen);
+        delete [] librarySource;
+
+        split = text.find('\n', text.find("#version"));
+        split = (split == string::npos) ? text.size() : split + 1;
+    }
+
+    string head = text.substr(0, split);
+    string tail = text.substr(split);
+    const char *src[3] = {head.c_str(), library.c_str(), tail.c_str()};
+
+    glShaderSource(stage, 3, src, NULL);
+
     GLint compiled;
-    
-    glCompileShader(v);
-    glGetShaderiv(v, GL_COMPILE_STATUS, &compiled);
+
+    glCompileShader(stage);
+    glGetShaderiv(stage, GL_COMPILE_STATUS, &compiled);
     if (!compiled)
     {
-        cout << "Vertex shader not compiled." << endl;
-        printShaderInfoLog(v);
+        cout << path << " not compiled." << endl;
+        printShaderInfoLog(stage);
     }
-    
-    glCompileShader(f);
-    glGetShaderiv(f, GL_COMPILE_STATUS, &compiled);
-    if (!compiled)
-    {
-        cout << "Fragment shader not compiled." << endl;
-        printShaderInfoLog(f);
+
+    return stage;
+}
+
+
+
+void Shader::compileShader()
+{
+    v = compileStage(GL_VERTEX_SHADER, vertexShaderPath);
+
+    if (hasFeedback())
+        g = compileStage(GL_GEOMETRY_SHADER, geometryShaderPath);
+    else
+        f = compileStage(GL_FRAGMENT_SHADER, fragmentShaderPath);
+
+    if (hasBoundingGeometry()) {
+        bv = compileStage(GL_VERTEX_SHADER, boundsVertexShaderPath);
+        bg = compileStage(GL_GEOMETRY_SHADER, boundsGeometryShaderPath);
     }
-    
-    delete [] vs; // dont forget to free allocated memory
-    delete [] fs; // we allocated this in the loadFile function...
 }
 
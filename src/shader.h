@@ -33,7 +33,10 @@
 
 #include <GL/glew.h>
 
+#include "vao.h"
+
 #define PATH_TO_SHADERS "../src/shaders/"
+#define SPLAT_SETUP_SHADER "4_perspective-corrected/splatSetup.glsl" //ray-splat intersection set up, shared by the splat vertex stages
 
 namespace shader
 {
@@ -41,7 +44,10 @@ namespace shader
         SINGLEPASS      = 0,
         DEPTH_MASK      = 1,
         BLENDING        = 2,
-        NORMALIZATION   = 3
+        NORMALIZATION   = 3,
+        WEIGHTED_BLENDING = 4,
+        TILE_DEPTH      = 5,
+        TILE_REPROJECTION = 6
     };
 }
 
@@ -55,9 +61,17 @@ private:
     string description;
     string vertexShaderPath;
     string fragmentShaderPath;
+    string boundsVertexShaderPath;
+    string boundsGeometryShaderPath;
+    string geometryShaderPath;
+    vector<string> feedbackVaryings;
+    bool cachedInput;
+    bool surfaceAttributes;
     shaderMode mode;
     vector<vector<Shader> > multiPass;
 
+    GLuint compileStage(GLenum type, string path);
+
         
 public:
     
@@ -67,6 +81,8 @@ public:
     //variables
     GLint program;   //Shader program
     GLuint f, v;     //fragment and vertex shader
+    GLuint bv, bg;   //vertex and geometry shader emitting tight splat bounds
+    GLuint g;        //geometry shader whose output is captured by transform feedback
     
     //Uniform locations
     GLint projMatrixLoc, viewMatrixLoc, normalMatrixLoc;
@@ -75,10 +91,22 @@ public:
     GLint radiusSplatLoc;
     GLint colorEnabledLoc;
     GLint automaticRadiusEnabledLoc;
+    GLint cachedInputLoc;
     GLint renderTextureLoc;
     GLint blendTextureLoc;
     GLint normalTextureLoc;
     GLint positionTextureLoc;
+    GLint tileDepthTextureLoc;
+    GLint tileHistoryTextureLoc;
+    GLint reprojectionMatrixLoc, previousProjMatrixLoc, previousSizeLoc;
+    GLint depthTextureLoc;
+    GLint coarseTextureLoc;
+    GLint coarseDepthTextureLoc;
+    GLint firstLevelLoc;
+    GLint levelSizeLoc;
+    GLint tileSizeLoc;
+    GLint depthWindowLoc;
+    GLint depthRangeLoc;
     GLint inverseTextureSizeLoc;
     GLint lightCountLoc;
     GLint lightPositionLoc;
@@ -97,6 +125,15 @@ public:
     vector<Shader> &getMultiPass(int i) { return multiPass[i]; };
     vector< vector<Shader> > &getMultiPass() { return multiPass; };
     shaderMode getMode() {return mode; };
+    vertexStream getStreams() { return (mode == DEPTH_MASK) ? GEOMETRY_STREAM : ALL_STREAMS; }; //the visibility pass never reads colors
+    void setBoundingGeometry(string vertexShaderPath, string geometryShaderPath);
+    bool hasBoundingGeometry() { return !boundsGeometryShaderPath.empty(); };
+    void setFeedback(string geometryShaderPath, vector<string> varyings);
+    bool hasFeedback() { return !feedbackVaryings.empty(); };
+    void setCachedInput(bool cachedInput) { this->cachedInput = cachedInput; };
+    bool acceptsCachedInput() { return cachedInput; };
+    void setSurfaceAttributes(bool surfaceAttributes) { this->surfaceAttributes = surfaceAttributes; };
+    bool readsSurfaceAttributes() { return surfaceAttributes; }; //normals & radii, whatever the flags
     
     void printShaderInfoLog(GLint shader);
     void bindShader();
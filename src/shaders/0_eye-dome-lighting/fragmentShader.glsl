@@ -0,0 +1,75 @@
+//Eye-Dome-Lighting
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform sampler2DRect depthTexture;
+uniform float n; //Near parameter of the viewing frustum
+uniform float f; //Far parameter of the viewing frustum
+
+out vec4 out_Color;
+
+layout(pixel_center_integer) in vec4 gl_FragCoord;
+
+const float edlRadius = 1.5f;     //pixels between a fragment and its neighbours
+const float edlStrength = 300.0f; //darkening per unit of log depth difference
+const float edlSilhouette = 0.8f; //darkening of the background surrounded by the cloud
+
+//log2 of the eye distance, so the shading is the same at any depth
+float logDepth(float depth)
+{
+	float z = 2.0 * depth - 1.0; //Back to NDC
+	return log2((2.0 * n * f) / (f + n - z * (f - n)));
+}
+
+void main(void)
+{
+	vec2 neighbours[8] = vec2[](vec2(1, 0), vec2(0.707, 0.707), vec2(0, 1), vec2(-0.707, 0.707),
+	                            vec2(-1, 0), vec2(-0.707, -0.707), vec2(0, -1), vec2(0.707, -0.707));
+
+	float depth = texture(depthTexture, gl_FragCoord.xy).r;
+	bool background = depth >= 1.0;
+
+	//How far behind its neighbours the fragment lies, in log depth. The
+	//background only counts the neighbours on the cloud, outlining it
+	float response = 0.0;
+	for (int i = 0; i < 8; i++) {
+		float neighbourDepth = texture(depthTexture, gl_FragCoord.xy + neighbours[i] * edlRadius).r;
+		if (neighbourDepth >= 1.0)
+			continue;
+
+		if (background)
+			response += 1.0;
+		else
+			response += max(0.0, logDepth(depth) - logDepth(neighbourDepth));
+	}
+	response /= 8.0;
+
+	//Multiplies the color in the framebuffer
+	float shade = background ? 1.0 - edlSilhouette * response : exp(-response * edlStrength);
+	out_Color = vec4(vec3(shade), 1.0f);
+}
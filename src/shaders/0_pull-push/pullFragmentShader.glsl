@@ -0,0 +1,96 @@
+//Pull-Push
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform sampler2DRect renderTexture; //color of the finer level, premultiplied by its weight
+uniform sampler2DRect depthTexture;  //eye depth of the finer level
+uniform bool firstLevel;             //the finer level is the framebuffer: plain color & window depth
+uniform ivec2 levelSize;             //part of the finer level in use, the frame may be smaller than its textures
+uniform float n; //Near parameter of the viewing frustum
+uniform float f; //Far parameter of the viewing frustum
+
+layout(location = 0) out vec4 out_Color;
+layout(location = 1) out float out_Depth;
+
+const float depthTolerance = 0.05f; //relative depth gap between two surfaces
+
+float eyeDepth(float depth)
+{
+	float z = 2.0 * depth - 1.0; //Back to NDC
+	return (2.0 * n * f) / (f + n - z * (f - n));
+}
+
+void fetch(ivec2 texel, out vec4 color, out float depth)
+{
+	texel = min(texel, levelSize - 1);
+
+	if (firstLevel) {
+		float windowDepth = texelFetch(depthTexture, texel).r;
+		float weight = (windowDepth < 1.0) ? 1.0 : 0.0;
+		color = vec4(texelFetch(renderTexture, texel).rgb * weight, weight);
+		depth = eyeDepth(windowDepth);
+	}
+	else {
+		color = texelFetch(renderTexture, texel);
+		depth = texelFetch(depthTexture, texel).r;
+	}
+}
+
+void main(void)
+{
+	ivec2 coarse = ivec2(gl_FragCoord.xy);
+
+	vec4 color[4];
+	float depth[4];
+	float nearest = 1e30;
+	for (int i = 0; i < 4; i++) {
+		fetch(2 * coarse + ivec2(i % 2, i / 2), color[i], depth[i]);
+		if (color[i].a > 0.0)
+			nearest = min(nearest, depth[i]);
+	}
+
+	//Only the children on the nearest surface, so the background does not leak through the gaps
+	vec4 sum = vec4(0.0);
+	float depthSum = 0.0;
+	for (int i = 0; i < 4; i++)
+		if (color[i].a > 0.0 && depth[i] <= nearest * (1.0 + depthTolerance)) {
+			sum += color[i];
+			depthSum += depth[i] * color[i].a;
+		}
+
+	//Full weight as soon as half of the children are covered
+	if (sum.a > 0.0) {
+		float weight = min(1.0, sum.a / 2.0);
+		out_Color = vec4(sum.rgb / sum.a * weight, weight);
+		out_Depth = depthSum / sum.a;
+	}
+	else {
+		out_Color = vec4(0.0);
+		out_Depth = 0.0;
+	}
+}
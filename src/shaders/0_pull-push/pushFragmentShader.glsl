@@ -0,0 +1,97 @@
+//Pull-Push
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform sampler2DRect renderTexture;      //color of this level, premultiplied by its weight
+uniform sampler2DRect depthTexture;       //eye depth of this level
+uniform sampler2DRect coarseTexture;      //color of the coarser level, already filled
+uniform sampler2DRect coarseDepthTexture; //eye depth of the coarser level
+uniform bool firstLevel;                  //this level is the framebuffer: plain color & window depth, written back
+uniform ivec2 levelSize;                  //part of the coarser level in use, the frame may be smaller than its textures
+uniform float n; //Near parameter of the viewing frustum
+uniform float f; //Far parameter of the viewing frustum
+
+layout(location = 0) out vec4 out_Color;
+layout(location = 1) out float out_Depth;
+
+const float depthTolerance = 0.05f; //relative depth gap between two surfaces
+const float minCoverage = 0.5f;     //filled pixels less covered than this are background
+
+float eyeDepth(float depth)
+{
+	float z = 2.0 * depth - 1.0; //Back to NDC
+	return (2.0 * n * f) / (f + n - z * (f - n));
+}
+
+float windowDepth(float depth)
+{
+	float z = (f + n - 2.0 * n * f / depth) / (f - n);
+	return 0.5 * z + 0.5;
+}
+
+void main(void)
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+
+	vec4 fine;
+	float fineDepth;
+	if (firstLevel) {
+		float depth = texelFetch(depthTexture, texel).r;
+		float weight = (depth < 1.0) ? 1.0 : 0.0;
+		fine = vec4(texelFetch(renderTexture, texel).rgb * weight, weight);
+		fineDepth = eyeDepth(depth);
+	}
+	else {
+		fine = texelFetch(renderTexture, texel);
+		fineDepth = texelFetch(depthTexture, texel).r;
+	}
+
+	ivec2 parent = min(texel / 2, levelSize - 1);
+	vec4 coarse = texelFetch(coarseTexture, parent);
+	float coarseDepth = texelFetch(coarseDepthTexture, parent).r;
+
+	//A sample behind the surface filled at the coarser level is seen through a gap
+	if (fine.a > 0.0 && coarse.a > 0.0 && fineDepth > coarseDepth * (1.0 + depthTolerance))
+		fine = vec4(0.0);
+
+	//The coarser level fills what this one lacks
+	vec4 color = fine + (1.0 - fine.a) * coarse;
+	float depth = (fine.a * fineDepth + (1.0 - fine.a) * coarse.a * coarseDepth) / max(color.a, 1e-6);
+
+	if (firstLevel) {
+		if (color.a < minCoverage)
+			discard;
+
+		out_Color = vec4(color.rgb / color.a, 1.0);
+		gl_FragDepth = windowDepth(depth);
+	}
+	else {
+		out_Color = color;
+		out_Depth = depth;
+	}
+}
@@ -32,6 +32,7 @@ uniform mat3 normalMatrix;
 uniform bool colorEnabled;
 
 in  vec3 in_Position;
+in  mat4 in_ModelMatrix; //per instance, identity outside scenes
 in  vec3 in_Color;
 in  vec3 in_Normals;
 
@@ -39,7 +40,7 @@ out vec3 ex_Color;
 
 void main(void)
 {
-	gl_Position = projMatrix * viewMatrix * vec4(in_Position, 1.0);
+	gl_Position = projMatrix * viewMatrix * in_ModelMatrix * vec4(in_Position, 1.0);
 	gl_PointSize = 2;
 
 	vec3 color = vec3 (0.0, 0.0f, 0.0f);
@@ -47,7 +48,7 @@ void main(void)
 	//Diffuse
 	if (colorEnabled == true) {
 		vec3 lightDirection = vec3(0.0,0.0,1.0f);
-		float dotValue = max(dot(normalize(normalMatrix * in_Normals), lightDirection), 0.0);
+		float dotValue = max(dot(normalize(normalMatrix * mat3(in_ModelMatrix) * in_Normals), lightDirection), 0.0);
 		ex_Color = vec3(dotValue) + color;
 	}
 	else
@@ -39,6 +39,7 @@ uniform bool automaticRadiusEnabled;
 
 in float in_Radius;
 in  vec3 in_Position;
+in  mat4 in_ModelMatrix; //per instance, identity outside scenes
 in  vec3 in_Color;
 in 	vec3 in_Normals;
 
@@ -51,18 +52,18 @@ vec4 ccPosition; //position in Camera Coordinates
 
 void main(void)
 {
-	ex_Normals = normalize(normalMatrix * in_Normals);
+	ex_Normals = normalize(normalMatrix * mat3(in_ModelMatrix) * in_Normals);
 
 	if (abs(ex_Normals.z) <= 0.1)
 		ex_Normals.z = 0.1;
 
 	if (automaticRadiusEnabled == true)
-		ex_Radius = in_Radius * userRadiusFactor;
+		ex_Radius = in_Radius * userRadiusFactor * length(in_ModelMatrix[0].xyz);
 	else
 		ex_Radius = userRadiusFactor;
 
 	//p. 277
-	ccPosition = viewMatrix * vec4(in_Position, 1.0);
+	ccPosition = viewMatrix * in_ModelMatrix * vec4(in_Position, 1.0);
 	gl_Position = projMatrix * ccPosition;
 	gl_PointSize = 2*ex_Radius * (n / ccPosition.z) * (h / (t-b));
 
@@ -75,7 +76,7 @@ void main(void)
 	//Diffuse
 	if (colorEnabled == true) {
 		vec3 lightDirection = vec3(0.0,0.0,1.0f);
-		float dotValue = max(dot(normalize(normalMatrix * in_Normals), lightDirection), 0.0);
+		float dotValue = max(dot(normalize(normalMatrix * mat3(in_ModelMatrix) * in_Normals), lightDirection), 0.0);
 		ex_Color = vec3(dotValue) + color;
 	}
 	else
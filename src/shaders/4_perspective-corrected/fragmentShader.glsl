@@ -30,12 +30,6 @@
 uniform mat4 viewMatrix;
 uniform float n; //Near parameter of the viewing frustum
 uniform float f; //Far parameter of the viewing frustum
-uniform float t; //Top parameter of the viewing frustum
-uniform float b; //Bottom parameter of the viewing frustum
-uniform float r; //Right parameter of the viewing frustum
-uniform float l; //Left parameter of the viewing frustum
-uniform int h; 	 //Height of the viewport
-uniform int w; 	 //Width of the viewport
 uniform bool colorEnabled;
 uniform int lightCount;
 uniform vec3 lightPosition[16];
@@ -47,6 +41,8 @@ in  vec3 ex_Color;
 in 	vec3 ex_UxV;
 in  vec3 normals;
 in 	vec4 ccPosition;
+flat in mat3 ex_PixelToSplat;
+flat in mat3 ex_SplatToCamera;
 
 out vec4 out_Color;
 
@@ -60,32 +56,17 @@ float LinearizeDepth(float depth)
 
 void main(void)
 {
-	//p. 280
-	vec3 qn;
+	//p. 280, ray-splat intersection set up per splat in the vertex stage
+	vec3 splat = ex_PixelToSplat * vec3(gl_FragCoord.xy, 1.0);
 
-	qn.x = (gl_FragCoord.x ) *  ((r - l)/w ) - ( (r - l)/2.0 );
-	qn.y = (gl_FragCoord.y ) *  ((b - t)/h ) - ( (b - t)/2.0 );
-	qn.z = -n;
-
-	float denom = dot (qn, normals);
-
-	if (denom == 0.0)
+	//splat.xy / splat.z are the splat local coordinates, in units of its radius
+	if (dot(splat.xy, splat.xy) > splat.z * splat.z)
 		discard;
 
-
-	//http://en.wikipedia.org/wiki/Line%E2%80%93plane_intersection
-	float timef = dot (ccPosition.xyz, normals ) / denom;
-
-	vec3 q = qn * timef;
+	vec3 q = ex_SplatToCamera * (splat / splat.z);
 	vec3 testq = q;
-
-	vec3 dist = (q - ccPosition.xyz);
-
-	if ((dist.x * dist.x) + (dist.y * dist.y) + (dist.z * dist.z) > pow(ex_Radius, 2))
-		discard;
 	
 	//p. 279
-	//q = lambda * qn;
 	gl_FragDepth = ((1.0 / q.z) * ( (f * n) / (f - n) ) + ( f / (f - n) ));
 
 	vec3 color = ex_Color;
@@ -0,0 +1,78 @@
+//Perspective Correct Rasterization, Splat Cache (Geometry)
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 410
+layout(points) in;
+layout(points, max_vertices = 1) out;
+
+uniform float n; //Near parameter of the viewing frustum
+uniform float f; //Far parameter of the viewing frustum
+uniform float t; //Top parameter of the viewing frustum
+uniform float b; //Bottom parameter of the viewing frustum
+uniform float r; //Right parameter of the viewing frustum
+uniform float l; //Left parameter of the viewing frustum
+
+in vec3 vs_ccPosition[];
+in vec3 vs_Color[];
+in vec3 vs_Normals[];
+in float vs_Radius[];
+
+//Captured with transform feedback, interleaved with the same layout as vaoVertex
+out vec3 tf_Position;
+out vec3 tf_Color;
+out vec3 tf_Normals;
+out float tf_Radius;
+
+
+void main(void)
+{
+	vec3 p = vs_ccPosition[0];
+	float radius = vs_Radius[0];
+	float depth = -p.z;
+
+	//Frustum culling of the splat's bounding sphere, culled splats are not
+	//emitted so the cache only holds the visible ones
+	if (depth + radius < n || depth - radius > f)
+		return;
+
+	float top = max(t, b);
+	float bottom = min(t, b);
+
+	if ((p.x * n - r * depth) / length(vec2(n, r)) > radius ||
+	    (l * depth - p.x * n) / length(vec2(n, l)) > radius ||
+	    (p.y * n - top * depth) / length(vec2(n, top)) > radius ||
+	    (bottom * depth - p.y * n) / length(vec2(n, bottom)) > radius)
+		return;
+
+	tf_Position = p;
+	tf_Color = vs_Color[0];
+	tf_Normals = vs_Normals[0];
+	tf_Radius = radius;
+	EmitVertex();
+	EndPrimitive();
+}
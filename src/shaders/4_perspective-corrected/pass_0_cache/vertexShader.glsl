@@ -0,0 +1,60 @@
+//Perspective Correct Rasterization, Splat Cache (Vertex)
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 410
+uniform mat4 viewMatrix;
+uniform mat3 normalMatrix;
+uniform float userRadiusFactor; //Splat's radii
+uniform bool automaticRadiusEnabled;
+
+in float in_Radius;
+in  vec3 in_Position;
+in  mat4 in_ModelMatrix; //per instance, identity outside scenes
+in  vec3 in_Color;
+in 	vec3 in_Normals;
+
+out vec3 vs_ccPosition; //position in Camera Coordinates
+out vec3 vs_Color;
+out vec3 vs_Normals;
+out float vs_Radius;
+
+
+void main(void)
+{
+	vs_Normals = normalize(normalMatrix * mat3(in_ModelMatrix) * in_Normals);
+
+	if (automaticRadiusEnabled == true)
+		vs_Radius = in_Radius * userRadiusFactor * length(in_ModelMatrix[0].xyz);
+	else
+		vs_Radius = userRadiusFactor;
+
+	//p. 277
+	vs_ccPosition = (viewMatrix * in_ModelMatrix * vec4(in_Position, 1.0)).xyz;
+
+	vs_Color = in_Color;
+}
@@ -29,17 +29,13 @@
 #version 410
 uniform float n; //Near parameter of the viewing frustum
 uniform float f; //Far parameter of the viewing frustum
-uniform float t; //Top parameter of the viewing frustum
-uniform float b; //Bottom parameter of the viewing frustum
-uniform float r; //Right parameter of the viewing frustum
-uniform float l; //Left parameter of the viewing frustum
-uniform int h; 	 //Height of the viewport
-uniform int w; 	 //Width of the viewport
 
 in float ex_Radius;
 in  vec3 ex_Color;
 in  vec3 normals;
 in 	vec4 ccPosition;
+flat in mat3 ex_PixelToSplat;
+flat in mat3 ex_SplatToCamera;
 
 layout (location = 0) out vec4 out_Color;
 layout (location = 1) out vec4 out_Normals;
@@ -54,36 +50,22 @@ float LinearizeDepth(float depth)
 
 void main(void)
 {
-	//p. 280
-	vec3 qn;
+	//p. 280, ray-splat intersection set up per splat in the vertex stage
+	vec3 splat = ex_PixelToSplat * vec3(gl_FragCoord.xy, 1.0);
 
-	qn.x = (gl_FragCoord.x ) *  ((r - l)/w ) - ( (r - l)/2.0 );
-	qn.y = (gl_FragCoord.y ) *  ((b - t)/h ) - ( (b - t)/2.0 );
-	qn.z = -n;
-
-	float denom = dot (qn, normals);
-
-	if (denom == 0.0)
+	//splat.xy / splat.z are the splat local coordinates, in units of its radius
+	if (dot(splat.xy, splat.xy) > splat.z * splat.z)
 		discard;
 
-
-	//http://en.wikipedia.org/wiki/Line%E2%80%93plane_intersection
-	float timef = dot (ccPosition.xyz, normals ) / denom;
-
-	vec3 q = qn * timef;
-
-	vec3 dist = (q - ccPosition.xyz);
-
-	if ((dist.x * dist.x) + (dist.y * dist.y) + (dist.z * dist.z) > pow(ex_Radius, 2))
-		discard;
+	vec3 q = ex_SplatToCamera * (splat / splat.z);
 	
-	//vec3 epsilon = normalize(qn)/120.0f;
-	vec3 epsilon = normalize(qn)/40.0f;
+	//vec3 epsilon = normalize(q)/120.0f;
+	vec3 epsilon = normalize(q)/40.0f;
 	q = q - epsilon;
 
 	//((1.0 / q.z) * ( (f * n) / (f - n) ) + ( f / (f - n) )) 
 	gl_FragDepth = ((1.0 / q.z) * ( (f * n) / (f - n) ) + ( f / (f - n) ));
-	float weight = (1.0f - length(dist)/ex_Radius);
+	float weight = (1.0f - length(splat.xy / splat.z));
 	
 	out_Color = vec4(ex_Color.rgb, 1.0f * weight); 
 	out_Normals = vec4(normals, 1.0f * weight);
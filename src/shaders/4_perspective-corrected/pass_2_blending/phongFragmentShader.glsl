@@ -30,12 +30,6 @@
 uniform mat4 viewMatrix;
 uniform float n; //Near parameter of the viewing frustum
 uniform float f; //Far parameter of the viewing frustum
-uniform float t; //Top parameter of the viewing frustum
-uniform float b; //Bottom parameter of the viewing frustum
-uniform float r; //Right parameter of the viewing frustum
-uniform float l; //Left parameter of the viewing frustum
-uniform int h; 	 //Height of the viewport
-uniform int w; 	 //Width of the viewport
 uniform bool colorEnabled;
 uniform int lightCount;
 uniform vec3 lightPosition[16];
@@ -46,6 +40,8 @@ in float ex_Radius;
 in  vec3 ex_Color;
 in  vec3 normals;
 in 	vec4 ccPosition;
+flat in mat3 ex_PixelToSplat;
+flat in mat3 ex_SplatToCamera;
 
 out vec4 out_Color;
 
@@ -61,40 +57,26 @@ float LinearizeDepth(float depth)
 
 void main(void)
 {
-	//p. 280
-	vec3 qn;
+	//p. 280, ray-splat intersection set up per splat in the vertex stage
+	vec3 splat = ex_PixelToSplat * vec3(gl_FragCoord.xy, 1.0);
 
-	qn.x = (gl_FragCoord.x ) *  ((r - l)/w ) - ( (r - l)/2.0 );
-	qn.y = (gl_FragCoord.y ) *  ((b - t)/h ) - ( (b - t)/2.0 );
-	qn.z = -n;
-
-	float denom = dot (qn, normals);
-
-	if (denom == 0.0)
+	//splat.xy / splat.z are the splat local coordinates, in units of its radius
+	if (dot(splat.xy, splat.xy) > splat.z * splat.z)
 		discard;
 
-
-	//http://en.wikipedia.org/wiki/Line%E2%80%93plane_intersection
-	float timef = dot (ccPosition.xyz, normals ) / denom;
-
-	vec3 q = qn * timef;
+	vec3 q = ex_SplatToCamera * (splat / splat.z);
 	vec3 testq = q;
 
-	vec3 dist = (q - ccPosition.xyz);
-
-	if ((dist.x * dist.x) + (dist.y * dist.y) + (dist.z * dist.z) > pow(ex_Radius, 2))
-		discard;
-
 
-	//vec3 epsilon = normalize(qn)/120.0f;
-	vec3 epsilon = normalize(qn)/40.0f;
+	//vec3 epsilon = normalize(q)/120.0f;
+	vec3 epsilon = normalize(q)/40.0f;
 	q = q - epsilon;
 	
 	//p. 279
 	gl_FragDepth = ((1.0 / q.z) * ( (f * n) / (f - n) ) + ( f / (f - n) ));
 
 	//Phong
-	float weight = (1.0f - length(dist)/ex_Radius);
+	float weight = (1.0f - length(splat.xy / splat.z));
 	vec3 phongNormal = normalize((q + normals) - ccPosition.xyz);
 
 	vec3 color = ex_Color;
@@ -106,7 +88,7 @@ void main(void)
 	for (int i = 0; i < lightCount; i++) {
 		vec3 ccLightPosition = (viewMatrix * vec4(lightPosition[i], 1.0f)).xyz;
 		vec3 lithToQ = normalize(ccLightPosition - testq);
-		dotValue += vec3(max(dot(normals, lithToQ), 0.0)) * lightIntensity[i] * lightColor[i];
+		dotValue += vec3(max(dot(phongNormal, lithToQ), 0.0)) * lightIntensity[i] * lightColor[i];
 	}
 
 	out_Color = vec4(dotValue + color, 1.0f * weight);
@@ -0,0 +1,59 @@
+//Tile Depth Fragment Shader
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 410
+uniform sampler2DRect positionTexture; //Nearest depth of each pixel, written by the weighted pass
+uniform int tileSize;                  //Side of a tile, in pixels
+uniform float depthWindow;             //Narrowest depth window
+uniform float depthRange;              //Farthest a pixel lies behind the nearest one of its tile and still belongs to its surface
+
+out vec4 out_Color;
+
+void main(void)
+{
+	ivec2 origin = ivec2(gl_FragCoord.xy) * tileSize;
+	ivec2 last = textureSize(positionTexture) - 1;
+
+	float minDepth = texelFetch(positionTexture, min(origin, last)).r;
+	for (int y = 0; y < tileSize; y++)
+		for (int x = 0; x < tileSize; x++)
+			minDepth = min(minDepth, texelFetch(positionTexture, min(origin + ivec2(x, y), last)).r);
+
+	//A surface slanted to the view spans more depth across the tile than a facing
+	//one: the window grows to the depth spread of the nearest surface of the tile,
+	//so its far side does not fade out
+	float surfaceDepth = minDepth;
+	for (int y = 0; y < tileSize; y++)
+		for (int x = 0; x < tileSize; x++) {
+			float depth = texelFetch(positionTexture, min(origin + ivec2(x, y), last)).r;
+			if (depth <= minDepth + depthRange)
+				surfaceDepth = max(surfaceDepth, depth);
+		}
+
+	out_Color = vec4(minDepth, max(surfaceDepth - minDepth, depthWindow), 0.0f, 1.0f);
+} 
@@ -0,0 +1,59 @@
+//Tile Reprojection Vertex Shader
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+ 
+#version 410
+uniform mat4 reprojectionMatrix;       //Clip space of the previous frame to clip space of this one
+uniform mat4 previousProjMatrix;       //Projection of the previous frame
+uniform ivec2 previousSize;            //Size of the previous frame, in pixels
+uniform sampler2DRect tileHistoryTexture; //Nearest depth & depth window of each tile in the previous frame
+uniform int tileSize;                  //Side of a tile, in pixels
+uniform float f; //Far parameter of the viewing frustum
+
+out vec2 ex_Tile;
+
+void main(void)
+{
+	//One point per tile of the previous frame, no vertex attributes
+	int tilesX = (previousSize.x + tileSize - 1) / tileSize;
+	ivec2 tile = ivec2(gl_VertexID % tilesX, gl_VertexID / tilesX);
+	vec2 history = texelFetch(tileHistoryTexture, tile).rg;
+	float depth = history.r;
+
+	//Center of the tile back in the clip space of the previous frame, at its nearest depth
+	vec2 ndc = (vec2(tile) + 0.5) * float(tileSize) / vec2(previousSize) * 2.0 - 1.0;
+	float zClip = previousProjMatrix[2][2] * -depth + previousProjMatrix[3][2];
+	gl_Position = reprojectionMatrix * vec4(ndc * depth, zClip, depth);
+	gl_PointSize = 2.0;
+
+	ex_Tile = vec2(gl_Position.w, history.g);
+
+	//Tiles no splat covered stay out of the reprojection
+	if (depth >= f)
+		gl_Position.w = 0;
+}
@@ -0,0 +1,93 @@
+//Weighted Phong Fragment Shader
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform mat4 viewMatrix;
+uniform float n; //Near parameter of the viewing frustum
+uniform float f; //Far parameter of the viewing frustum
+uniform bool colorEnabled;
+uniform int lightCount;
+uniform vec3 lightPosition[16];
+uniform vec3 lightColor[16];
+uniform float lightIntensity[16];
+uniform sampler2DRect tileDepthTexture; //Nearest depth & depth window of each tile, reprojected from the previous frame
+uniform int tileSize;                   //Side of a tile, in pixels
+
+in float ex_Radius;
+in  vec3 ex_Color;
+in  vec3 normals;
+in 	vec4 ccPosition;
+flat in mat3 ex_PixelToSplat;
+flat in mat3 ex_SplatToCamera;
+
+layout(location = 0) out vec4 out_Color;
+layout(location = 1) out vec4 out_Depth;
+
+
+void main(void)
+{
+	//p. 280, ray-splat intersection set up per splat in the vertex stage
+	vec3 splat = ex_PixelToSplat * vec3(gl_FragCoord.xy, 1.0);
+
+	//splat.xy / splat.z are the splat local coordinates, in units of its radius
+	if (dot(splat.xy, splat.xy) > splat.z * splat.z)
+		discard;
+
+	vec3 q = ex_SplatToCamera * (splat / splat.z);
+
+	//No visibility pass: every splat is blended, but those lying behind the
+	//nearest surface of the tile fade out exponentially with their distance to it
+	float depth = abs(q.z);
+	//The depth window is the distance at which a splat behind the nearest one weighs 1/e
+	vec2 tileDepth = texelFetch(tileDepthTexture, ivec2(gl_FragCoord.xy) / tileSize).rg;
+	//Clamped, so pixels covered only by farther splats keep weights above the
+	//RGBA16F precision and are normalized to their color instead of left blank
+	float depthWeight = exp(-min(max(depth - tileDepth.r, 0.0) / tileDepth.g, 8.0));
+
+	//Phong, with the normal of the blending pass of Phong
+	float weight = (1.0f - length(splat.xy / splat.z)) * depthWeight;
+	vec3 epsilon = normalize(q)/40.0f;
+	vec3 phongNormal = normalize(((q - epsilon) + normals) - ccPosition.xyz);
+
+	vec3 color = ex_Color;
+	if (colorEnabled == true)
+		color = vec3(0,0,0);
+
+	//Diffuse
+	vec3 dotValue = vec3(0,0,0);
+	for (int i = 0; i < lightCount; i++) {
+		vec3 ccLightPosition = (viewMatrix * vec4(lightPosition[i], 1.0f)).xyz;
+		vec3 lithToQ = normalize(ccLightPosition - q);
+		dotValue += vec3(max(dot(phongNormal, lithToQ), 0.0)) * lightIntensity[i] * lightColor[i];
+	}
+
+	out_Color = vec4(dotValue + color, 1.0f * weight);
+	//Blended with GL_MIN, reduced per tile for the next frame
+	out_Depth = vec4(depth, depth, depth, 1.0f);
+
+} 
@@ -0,0 +1,61 @@
+//Splat Setup
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+//Shared by the splat vertex stages: Shader::compileStage inserts it after the
+//#version line of every stage calling splatSetup, with the uniforms it reads
+uniform int h; //Height of the viewport
+uniform int w; //Width of the viewport
+uniform float n; //Near parameter of the viewing frustum
+uniform float t; //Top parameter of the viewing frustum
+uniform float b; //Bottom parameter of the viewing frustum
+uniform float r; //Right parameter of the viewing frustum
+uniform float l; //Left parameter of the viewing frustum
+
+
+//p. 280, ray-splat intersection set up once per splat: the view ray through
+//pixel (x, y) is pixelToRay * (x, y, 1) and the splat's plane is
+//splatToCamera * (s, t, 1), so the local coordinates (s, t, 1) of the
+//intersection are proportional to inverse(splatToCamera) * pixelToRay * (x, y, 1).
+//Returns the determinant of splatToCamera, 0 for a splat seen edge-on
+float splatSetup(vec3 normal, float radius, vec3 center, out mat3 splatToCamera, out mat3 pixelToSplat)
+{
+	vec3 axis = (abs(normal.x) > 0.9) ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+	vec3 u = normalize(cross(normal, axis)) * radius;
+	vec3 v = cross(normal, u);
+	splatToCamera = mat3(u, v, center);
+
+	mat3 pixelToRay = mat3(vec3((r - l)/w, 0.0, 0.0),
+	                       vec3(0.0, (b - t)/h, 0.0),
+	                       vec3(-(r - l)/2.0, -(b - t)/2.0, -n));
+
+	vec3 vxp = cross(v, center);
+	float det = dot(u, vxp);
+	pixelToSplat = transpose(mat3(vxp, cross(center, u), cross(u, v))) * pixelToRay / det;
+
+	return det;
+}
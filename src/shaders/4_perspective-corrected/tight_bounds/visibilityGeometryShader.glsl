@@ -0,0 +1,78 @@
+//Perspective Correct Rasterization, Tight Splat Bounds (Visibility Pass Geometry)
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 410
+layout(points) in;
+layout(triangle_strip, max_vertices = 4) out;
+
+uniform mat4 projMatrix;
+
+in float vs_Radius[];
+in vec4 vs_ccPosition[];
+in vec3 vs_Normals[];
+in float vs_Determinant[];
+flat in mat3 vs_PixelToSplat[];
+flat in mat3 vs_SplatToCamera[];
+
+out float ex_Radius;
+
+out vec4 ccPosition; //position in Camera Coordinates
+out vec3 normals;
+flat out mat3 ex_PixelToSplat;
+flat out mat3 ex_SplatToCamera;
+
+const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+
+void main(void)
+{
+	vec3 center = vs_ccPosition[0].xyz;
+	vec3 normal = vs_Normals[0];
+
+	//Splat seen edge-on
+	if (vs_Determinant[0] == 0.0)
+		return;
+
+	//Tangent frame of the splat, scaled by its radius
+	vec3 u = vs_SplatToCamera[0][0];
+	vec3 v = vs_SplatToCamera[0][1];
+
+	//The square circumscribing the splat's disc contains its projected ellipse
+	for (int i = 0; i < 4; i++) {
+		ex_Radius = vs_Radius[0];
+		ccPosition = vs_ccPosition[0];
+		normals = normal;
+		ex_PixelToSplat = vs_PixelToSplat[0];
+		ex_SplatToCamera = vs_SplatToCamera[0];
+
+		gl_Position = projMatrix * vec4(center + corners[i].x * u + corners[i].y * v, 1.0);
+		EmitVertex();
+	}
+
+	EndPrimitive();
+}
@@ -29,15 +29,14 @@
 #version 400
 uniform mat4 viewMatrix, projMatrix;
 uniform mat3 normalMatrix;
-uniform int h; //Height of the viewport
-uniform float n; //Near parameter of the viewing frustum
-uniform float t; //Top parameter of the viewing frustum
-uniform float b; //Bottom parameter of the viewing frustum
+//Viewport & frustum uniforms come with splatSetup.glsl
 uniform float userRadiusFactor; //Splat's radii
 uniform bool automaticRadiusEnabled;
+uniform bool cachedInput; //Attributes already in camera coordinates, captured by the splat cache
 
 in float in_Radius;
 in  vec3 in_Position;
+in  mat4 in_ModelMatrix; //per instance, identity outside scenes
 in  vec3 in_Color;
 in 	vec3 in_Normals;
 
@@ -46,23 +45,39 @@ out float ex_Radius;
 
 out vec4 ccPosition; //position in Camera Coordinates
 out vec3 normals;
+flat out mat3 ex_PixelToSplat;
+flat out mat3 ex_SplatToCamera;
 
 
 
 void main(void)
 {
-	normals = normalize(normalMatrix * in_Normals);
+	if (cachedInput == true) {
+		normals = in_Normals;
+		ex_Radius = in_Radius;
+		ccPosition = vec4(in_Position, 1.0);
+	}
+	else {
+		normals = normalize(normalMatrix * mat3(in_ModelMatrix) * in_Normals);
 
-	if (automaticRadiusEnabled == true)
-		ex_Radius = in_Radius * userRadiusFactor;
-	else
-		ex_Radius = userRadiusFactor;
+		if (automaticRadiusEnabled == true)
+			ex_Radius = in_Radius * userRadiusFactor * length(in_ModelMatrix[0].xyz);
+		else
+			ex_Radius = userRadiusFactor;
 
-	//p. 277
-	ccPosition = viewMatrix * vec4(in_Position, 1.0);
+		//p. 277
+		ccPosition = viewMatrix * in_ModelMatrix * vec4(in_Position, 1.0);
+	}
 	gl_Position = projMatrix * ccPosition;
 	gl_PointSize = 2 * ex_Radius * (n / ccPosition.z) * (h / (t-b));
 
+	//p. 280, ray-splat intersection set up once per splat
+	float det = splatSetup(normals, ex_Radius, ccPosition.xyz, ex_SplatToCamera, ex_PixelToSplat);
+
+	//Splat seen edge-on
+	if (det == 0.0)
+		gl_Position.w = 0;
+
 	//BackFace Culling
 	if (dot (ccPosition.xyz, normals) > 0)
 		gl_Position.w = 0;
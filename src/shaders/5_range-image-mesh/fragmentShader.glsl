@@ -0,0 +1,63 @@
+//Range-image-mesh
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform mat4 viewMatrix;
+uniform bool colorEnabled;
+uniform int lightCount;
+uniform vec3 lightPosition[16];
+uniform vec3 lightColor[16];
+uniform float lightIntensity[16];
+
+in  vec3 ex_Color;
+in  vec3 normals;
+in  vec4 ccPosition;
+
+out vec4 out_Color;
+
+void main(void)
+{
+	//Range images are seen from both sides, light the side facing the camera
+	vec3 normal = normalize(normals);
+	if (dot(ccPosition.xyz, normal) > 0)
+		normal = -normal;
+
+	vec3 color = ex_Color;
+	if (colorEnabled == true)
+		color = vec3(0,0,0);
+
+	//Diffuse
+	vec3 dotValue = vec3(0,0,0);
+	for (int i = 0; i < lightCount; i++) {
+		vec3 ccLightPosition = (viewMatrix * vec4(lightPosition[i], 1.0f)).xyz;
+		vec3 lightToFragment = normalize(ccLightPosition - ccPosition.xyz);
+		dotValue += vec3(max(dot(normal, lightToFragment), 0.0)) * lightIntensity[i] * lightColor[i];
+	}
+
+	out_Color = vec4(dotValue + color, 1.0f);
+}
@@ -0,0 +1,49 @@
+//Range-image-mesh
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com> 
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es> 
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com> 
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+ 
+#version 400
+uniform mat4 viewMatrix, projMatrix;
+uniform mat3 normalMatrix;
+
+in  vec3 in_Position;
+in  mat4 in_ModelMatrix; //per instance, identity outside scenes
+in  vec3 in_Color;
+in  vec3 in_Normals;
+
+out vec3 ex_Color;
+out vec3 normals;
+out vec4 ccPosition; //position in Camera Coordinates
+
+void main(void)
+{
+	normals = normalMatrix * mat3(in_ModelMatrix) * in_Normals;
+	ccPosition = viewMatrix * in_ModelMatrix * vec4(in_Position, 1.0);
+	gl_Position = projMatrix * ccPosition;
+
+	ex_Color = in_Color;
+}
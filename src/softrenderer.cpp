@@ -0,0 +1,414 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "softrenderer.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "globals.h"
+#include "camera.h"
+#include "light.h"
+
+
+SoftRenderer::SoftRenderer(unsigned int numOfThreads)
+{
+    width = height = 0;
+    tilesX = tilesY = 0;
+    phong = true;
+    generation = 0;
+    busyWorkers = 0;
+    stopping = false;
+    numOfJobs = 0;
+    nextJob = 0;
+
+    if (numOfThreads == 0)
+        numOfThreads = max(thread::hardware_concurrency(), 1u);
+
+    //The calling thread works too, it takes the last index
+    for (unsigned int i = 0; i < numOfThreads - 1; i++)
+        workers.push_back(thread(&SoftRenderer::workerLoop, this, i));
+}
+
+
+SoftRenderer::~SoftRenderer()
+{
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+
+void SoftRenderer::workerLoop(unsigned int threadIndex)
+{
+    unsigned long seen = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(poolMutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runJobs(threadIndex);
+
+        {
+            lock_guard<mutex> lock(poolMutex);
+            if (--busyWorkers == 0)
+                finished.notify_one();
+        }
+    }
+}
+
+
+void SoftRenderer::runJobs(unsigned int threadIndex)
+{
+    unsigned int i;
+    while ((i = nextJob.fetch_add(1)) < numOfJobs)
+        job(i, threadIndex);
+}
+
+
+/**
+ @brief Runs f(i, thread) for i in [0, count) on every thread of the pool and
+ returns when all of them are done
+ */
+void SoftRenderer::parallelFor(unsigned int count, function<void(unsigned int, unsigned int)> f)
+{
+    {
+        lock_guard<mutex> lock(poolMutex);
+        job = f;
+        numOfJobs = count;
+        nextJob = 0;
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    runJobs(workers.size());
+
+    unique_lock<mutex> lock(poolMutex);
+    finished.wait(lock, [&] { return busyWorkers == 0; });
+}
+
+
+void SoftRenderer::setModel(VAO *model)
+{
+    model->computeAttributes();
+    model->packVertices(geometryData, appearanceData);
+    splats.resize(geometryData.size());
+}
+
+
+void SoftRenderer::resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    tilesX = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    tilesY = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+}
+
+
+//Ray-splat intersection set up once per splat, as splatSetup in
+//shaders/4_perspective-corrected/splatSetup.glsl. Returns the determinant of
+//splatToCamera, 0 for a splat seen edge-on
+static float splatSetup(glm::vec3 normal, float radius, glm::vec3 center, const glm::mat3 &pixelToRay,
+                        glm::mat3 &splatToCamera, glm::mat3 &pixelToSplat)
+{
+    glm::vec3 axis = (fabs(normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 u = glm::normalize(glm::cross(normal, axis)) * radius;
+    glm::vec3 v = glm::cross(normal, u);
+    splatToCamera = glm::mat3(u, v, center);
+
+    glm::vec3 vxp = glm::cross(v, center);
+    float det = glm::dot(u, vxp);
+    if (det != 0.0f)
+        pixelToSplat = glm::transpose(glm::mat3(vxp, glm::cross(center, u), glm::cross(u, v))) * pixelToRay / det;
+
+    return det;
+}
+
+
+/**
+ @brief Vertex stage of the blending shaders for splats [first, last), and
+ binning of their footprints into the tiles of bins[chunk]
+ */
+void SoftRenderer::setupSplats(size_t first, size_t last, unsigned int chunk)
+{
+    const glm::mat4 &viewMatrix = Camera::viewMatrix;
+    const glm::mat4 &projMatrix = Camera::projMatrix;
+    const glm::mat3 &normalMatrix = Camera::normalMatrix;
+    float n = Camera::n;
+    float t = Camera::top, b = Camera::bottom, r = Camera::right, l = Camera::left;
+    float w = width, h = height;
+
+    glm::mat3 pixelToRay = glm::mat3(glm::vec3((r - l)/w, 0.0f, 0.0f),
+                                     glm::vec3(0.0f, (b - t)/h, 0.0f),
+                                     glm::vec3(-(r - l)/2.0f, -(b - t)/2.0f, -n));
+
+    vector<vector<size_t> > &chunkBins = bins[chunk];
+    for (unsigned int i = 0; i < chunkBins.size(); i++)
+        chunkBins[i].clear();
+
+    for (size_t i = first; i < last; i++) {
+        softSplat &splat = splats[i];
+        splat.x0 = 0;
+        splat.x1 = -1;
+
+        glm::vec3 normal = glm::normalize(normalMatrix * geometryData[i].normal);
+        float radius = Globals::automaticRadiusEnabled ? geometryData[i].radius * Globals::userRadiusFactor
+                                                       : Globals::userRadiusFactor;
+        glm::vec4 ccPosition = viewMatrix * glm::vec4(geometryData[i].position, 1.0f);
+
+        //Points are clipped by their center
+        glm::vec4 clip = projMatrix * ccPosition;
+        if (clip.w <= 0 || fabs(clip.x) > clip.w || fabs(clip.y) > clip.w || fabs(clip.z) > clip.w)
+            continue;
+
+        glm::vec3 p = glm::vec3(ccPosition);
+
+        //Splat seen edge-on
+        if (splatSetup(normal, radius, p, pixelToRay, splat.splatToCamera, splat.pixelToSplat) == 0.0f)
+            continue;
+
+        splat.normal = normal;
+        splat.color = Globals::colorEnabled ? glm::vec3(0.0f) : appearanceData[i].color;
+        splat.backFace = glm::dot(p, normal) > 0;
+
+        //Pixels whose centers fall inside the point sprite
+        float size = fabs(2 * radius * (n / p.z) * (h / (t - b)));
+        float cx = (clip.x / clip.w + 1.0f) * 0.5f * w;
+        float cy = (clip.y / clip.w + 1.0f) * 0.5f * h;
+        splat.x0 = max((int) ceilf(cx - size * 0.5f - 0.5f), 0);
+        splat.y0 = max((int) ceilf(cy - size * 0.5f - 0.5f), 0);
+        splat.x1 = min((int) floorf(cx + size * 0.5f - 0.5f), width - 1);
+        splat.y1 = min((int) floorf(cy + size * 0.5f - 0.5f), height - 1);
+
+        if (splat.x0 > splat.x1 || splat.y0 > splat.y1)
+            continue;
+
+        for (int ty = splat.y0 / SOFT_TILE_SIZE; ty <= splat.y1 / SOFT_TILE_SIZE; ty++)
+            for (int tx = splat.x0 / SOFT_TILE_SIZE; tx <= splat.x1 / SOFT_TILE_SIZE; tx++)
+                chunkBins[ty * tilesX + tx].push_back(i);
+    }
+}
+
+
+/**
+ @brief Rasterizes the three passes of one tile. The per pixel loops work on
+ one row of a splat at a time, without branches, so they can be vectorized.
+ @param tile index of the tile
+ @param pixels RGB output, bottom row first
+ */
+void SoftRenderer::renderTile(unsigned int tile, vector<unsigned char> &pixels)
+{
+    const int T = SOFT_TILE_SIZE;
+    int tx0 = (tile % tilesX) * T;
+    int ty0 = (tile / tilesX) * T;
+    int tx1 = min(tx0 + T, width) - 1;
+    int ty1 = min(ty0 + T, height) - 1;
+
+    float depth[T * T];
+    float red[T * T], green[T * T], blue[T * T], weight[T * T];
+    std::fill(depth, depth + T * T, 1.0f);
+    std::fill(red, red + T * T, 0.0f);
+    std::fill(green, green + T * T, 0.0f);
+    std::fill(blue, blue + T * T, 0.0f);
+    std::fill(weight, weight + T * T, 0.0f);
+
+    //Row scratch buffers
+    float qx[T], qy[T], qz[T], rowWeight[T];
+    float litR[T], litG[T], litB[T];
+
+    float n = Camera::n, f = Camera::f;
+    float depthScale = (f * n) / (f - n);
+    float depthBias = f / (f - n);
+
+    //Lights in camera coordinates
+    int lightCount = Light::lightCount;
+    glm::vec3 ccLights[MAX_LIGHTS];
+    for (int i = 0; i < lightCount; i++)
+        ccLights[i] = glm::vec3(Camera::viewMatrix * glm::vec4(Light::lightPosition[3*i],
+                                                                Light::lightPosition[3*i + 1],
+                                                                Light::lightPosition[3*i + 2], 1.0f));
+
+    //Pass 1: visibility, nearest depth of the splats
+    for (unsigned int c = 0; c < bins.size(); c++) {
+        vector<size_t> &bin = bins[c][tile];
+        for (size_t k = 0; k < bin.size(); k++) {
+            const softSplat &s = splats[bin[k]];
+            const glm::mat3 &P = s.pixelToSplat;
+            const glm::mat3 &S = s.splatToCamera;
+            int xa = max(s.x0, tx0), xb = min(s.x1, tx1);
+            int ya = max(s.y0, ty0), yb = min(s.y1, ty1);
+
+            for (int y = ya; y <= yb; y++) {
+                float fy = y + 0.5f;
+                float bx = P[1][0] * fy + P[2][0];
+                float by = P[1][1] * fy + P[2][1];
+                float bz = P[1][2] * fy + P[2][2];
+                float *rowDepth = &depth[(y - ty0) * T - tx0];
+
+                for (int x = xa; x <= xb; x++) {
+                    float fx = x + 0.5f;
+                    float a = P[0][0] * fx + bx;
+                    float b = P[0][1] * fx + by;
+                    float cz = P[0][2] * fx + bz;
+                    float z = (S[0][2] * a + S[1][2] * b) / cz + S[2][2];
+                    float d = min(max(depthScale / z + depthBias, 0.0f), 1.0f);
+                    bool inside = a * a + b * b <= cz * cz;
+                    rowDepth[x] = (inside && d < rowDepth[x]) ? d : rowDepth[x];
+                }
+            }
+        }
+    }
+
+    //Pass 2: blending of the splats within the depth epsilon
+    for (unsigned int c = 0; c < bins.size(); c++) {
+        vector<size_t> &bin = bins[c][tile];
+        for (size_t k = 0; k < bin.size(); k++) {
+            const softSplat &s = splats[bin[k]];
+            if (s.backFace)
+                continue;
+
+            const glm::mat3 &P = s.pixelToSplat;
+            const glm::mat3 &S = s.splatToCamera;
+            int xa = max(s.x0, tx0), xb = min(s.x1, tx1);
+            int ya = max(s.y0, ty0), yb = min(s.y1, ty1);
+            int count = xb - xa + 1;
+
+            for (int y = ya; y <= yb; y++) {
+                float fy = y + 0.5f;
+                float bx = P[1][0] * fy + P[2][0];
+                float by = P[1][1] * fy + P[2][1];
+                float bz = P[1][2] * fy + P[2][2];
+                int row = (y - ty0) * T + (xa - tx0);
+
+                for (int i = 0; i < count; i++) {
+                    float fx = xa + i + 0.5f;
+                    float a = P[0][0] * fx + bx;
+                    float b = P[0][1] * fx + by;
+                    float cz = P[0][2] * fx + bz;
+                    float sa = a / cz, sb = b / cz;
+
+                    qx[i] = S[0][0] * sa + S[1][0] * sb + S[2][0];
+                    qy[i] = S[0][1] * sa + S[1][1] * sb + S[2][1];
+                    qz[i] = S[0][2] * sa + S[1][2] * sb + S[2][2];
+
+                    float length = sqrtf(qx[i] * qx[i] + qy[i] * qy[i] + qz[i] * qz[i]);
+                    float z = qz[i] * (1.0f - SOFT_DEPTH_EPSILON / length);
+                    float d = min(max(depthScale / z + depthBias, 0.0f), 1.0f);
+                    float radial = sqrtf(sa * sa + sb * sb);
+
+                    bool pass = (radial <= 1.0f) && (d <= depth[row + i]);
+                    float w = phong ? 1.0f - radial : 1.0f;
+                    rowWeight[i] = pass ? w : 0.0f;
+
+                    litR[i] = s.color.r;
+                    litG[i] = s.color.g;
+                    litB[i] = s.color.b;
+                }
+
+                //Diffuse
+                for (int l = 0; l < lightCount; l++) {
+                    glm::vec3 L = ccLights[l];
+                    glm::vec3 C = glm::vec3(Light::lightColor[3*l], Light::lightColor[3*l + 1], Light::lightColor[3*l + 2])
+                                  * Light::lightIntensity[l];
+                    for (int i = 0; i < count; i++) {
+                        float dx = L.x - qx[i], dy = L.y - qy[i], dz = L.z - qz[i];
+                        float lambert = (s.normal.x * dx + s.normal.y * dy + s.normal.z * dz)
+                                        / sqrtf(dx * dx + dy * dy + dz * dz);
+                        lambert = max(lambert, 0.0f);
+                        litR[i] += lambert * C.r;
+                        litG[i] += lambert * C.g;
+                        litB[i] += lambert * C.b;
+                    }
+                }
+
+                for (int i = 0; i < count; i++) {
+                    red[row + i] += litR[i] * rowWeight[i];
+                    green[row + i] += litG[i] * rowWeight[i];
+                    blue[row + i] += litB[i] * rowWeight[i];
+                    weight[row + i] += rowWeight[i];
+                }
+            }
+        }
+    }
+
+    //Pass 3: normalization over the background
+    for (int y = ty0; y <= ty1; y++) {
+        for (int x = tx0; x <= tx1; x++) {
+            int i = (y - ty0) * T + (x - tx0);
+            unsigned char *pixel = &pixels[(y * width + x) * 3];
+
+            if (weight[i] <= 0.0f) {
+                pixel[0] = 86;
+                pixel[1] = 136;
+                pixel[2] = 199;
+            }
+            else {
+                pixel[0] = (unsigned char) (min(max(red[i] / weight[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+                pixel[1] = (unsigned char) (min(max(green[i] / weight[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+                pixel[2] = (unsigned char) (min(max(blue[i] / weight[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+
+/**
+ @brief Renders the model with the current Camera & lights
+ @param pixels RGB bytes, bottom row first as glReadPixels returns them
+ */
+void SoftRenderer::render(vector<unsigned char> &pixels)
+{
+    pixels.resize(width * height * 3);
+
+    //Fixed chunks, so each tile blends its splats in submission order whatever thread set them up
+    unsigned int numOfChunks = getNumOfThreads() * 4;
+    size_t chunkSize = (splats.size() + numOfChunks - 1) / numOfChunks;
+    bins.resize(numOfChunks);
+    for (unsigned int i = 0; i < numOfChunks; i++)
+        bins[i].resize(tilesX * tilesY);
+
+    parallelFor(numOfChunks, [&] (unsigned int chunk, unsigned int) {
+        size_t first = min(chunk * chunkSize, splats.size());
+        size_t last = min((chunk + 1) * chunkSize, splats.size());
+        setupSplats(first, last, chunk);
+    });
+
+    parallelFor(tilesX * tilesY, [&] (unsigned int tile, unsigned int) {
+        renderTile(tile, pixels);
+    });
+}
@@ -0,0 +1,107 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__softrenderer__
+#define __CUBE__softrenderer__
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+#include "vao.h"
+
+#define SOFT_TILE_SIZE 32               //side in pixels of the screen tiles rasterized by one thread
+#define SOFT_DEPTH_EPSILON (1.0f/40.0f) //same depth offset as the blending pass shaders
+
+using namespace std;
+
+//Per splat set up of the vertex stage, done once per frame
+struct softSplat {
+    glm::mat3 pixelToSplat;     //ex_PixelToSplat
+    glm::mat3 splatToCamera;    //ex_SplatToCamera
+    glm::vec3 normal;           //camera coordinates
+    glm::vec3 color;
+    int x0, y0, x1, y1;         //point sprite footprint in pixels, inclusive
+    bool backFace;              //only written to the visibility pass
+};
+
+/**
+ @brief CPU implementation of the perspective-corrected three pass surfel
+ algorithm (visibility, blending with a depth epsilon, normalization) with
+ Gouraud or Phong weights. Splats are binned into screen tiles which are
+ rasterized in parallel; each tile keeps its own depth & accumulation buffers.
+ Reads the geometry & appearance streams of a VAO and the Camera & Light state.
+ */
+class SoftRenderer {
+
+private:
+    int width, height;
+    int tilesX, tilesY;
+    bool phong;
+
+    vector<vaoGeometry> geometryData;
+    vector<vaoAppearance> appearanceData;
+    vector<softSplat> splats;
+    vector<vector<vector<size_t> > > bins;   //[chunk][tile], splats in submission order
+
+    //Thread pool, jobs are handed out with an atomic counter so idle threads take the next tile
+    vector<thread> workers;
+    mutex poolMutex;
+    condition_variable wakeUp, finished;
+    unsigned long generation;
+    unsigned int busyWorkers;
+    bool stopping;
+    atomic<unsigned int> nextJob;
+    unsigned int numOfJobs;
+    function<void(unsigned int, unsigned int)> job;
+
+    void workerLoop(unsigned int threadIndex);
+    void runJobs(unsigned int threadIndex);
+    void parallelFor(unsigned int count, function<void(unsigned int, unsigned int)> f);
+
+    void setupSplats(size_t first, size_t last, unsigned int chunk);
+    void renderTile(unsigned int tile, vector<unsigned char> &pixels);
+
+public:
+    SoftRenderer(unsigned int numOfThreads = 0);
+    ~SoftRenderer();
+
+    void setModel(VAO *model);
+    void setPhong(bool phong) { this->phong = phong; };
+    void resize(int width, int height);
+    void render(vector<unsigned char> &pixels);
+    unsigned int getNumOfThreads() { return workers.size() + 1; };
+
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#include "splatcache.h"
+#include "profiler.h"
+
+SplatCache::SplatCache() :
+    captureShader("Splat Cache",
+                  "4_perspective-corrected/pass_0_cache/vertexShader.glsl",
+                  "",
+                  SINGLEPASS)
+{
+    vector<string> varyings;
+    varyings.push_back("tf_Position");
+    varyings.push_back("tf_Color");
+    varyings.push_back("tf_Normals");
+    varyings.push_back("tf_Radius");
+    captureShader.setFeedback("4_perspective-corrected/pass_0_cache/geometryShader.glsl", varyings);
+
+    vaoID = 0;
+    bufferID = 0;
+    feedbackID = 0;
+    capacity = 0;
+    initialized = false;
+}
+
+
+/**
+ @brief Creates the GL objects of the cache. Needs a current context.
+ */
+void SplatCache::init()
+{
+    captureShader.compileShader();
+
+    glGenBuffers(1, &bufferID);
+    glGenTransformFeedbacks(1, &feedbackID);
+
+    //Captured splats keep the vaoVertex layout, so the splat shaders read them through the same attributes
+    glGenVertexArrays(1, &vaoID);
+    glBindVertexArray(vaoID);
+    glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(0));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)) );
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)*2) );
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)*3) );
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbackID);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, bufferID);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+
+    initialized = true;
+}
+
+
+/**
+ @brief Grows the capture buffer, it never shrinks
+ @param bytes size needed
+ */
+void SplatCache::reserve(GLsizeiptr bytes)
+{
+    if (bytes <= capacity)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+    glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_DYNAMIC_COPY);
+    capacity = bytes;
+}
+
+
+/**
+ @brief Transforms and culls every splat of a model into the cache. Binds the
+ capture shader, so the caller has to bind its own shader afterwards.
+ @param vao model to capture
+ */
+void SplatCache::capture(VAO *vao)
+{
+    if (!initialized)
+        init();
+
+    reserve(sizeof(vaoVertex) * vao->getNumOfVertices());
+
+    captureShader.bindShader();
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbackID);
+    glBeginTransformFeedback(GL_POINTS);
+
+    glBindVertexArray(vao->getVAOid());
+    vao->draw();
+
+    glEndTransformFeedback();
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+}
+
+
+/**
+ @brief Draws the splats of the last capture, the count never leaves the GPU
+ */
+void SplatCache::draw()
+{
+    glBindVertexArray(vaoID);
+    glDrawTransformFeedback(GL_POINTS, feedbackID);
+    Profiler::countDraw(0);
+}
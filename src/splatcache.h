@@ -0,0 +1,72 @@
+/*
+ *
+ * CUBE
+ *
+ * Copyright (c) David Antunez Gonzalez 2013-2015 <dantunezglez@gmail.com>
+ * Copyright (c) Luis Omar Alvarez Mures 2013-2015 <omar.alvarez@udc.es>
+ * Copyright (c) Emilio Padron Gonzalez 2013-2015 <emilioj@gmail.com>
+ *
+ * All rights reserved.
+ *
+ * This file is part of ToView.
+ *
+ * CUBE is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.
+ *
+ */
+
+#ifndef __CUBE__splatcache__
+#define __CUBE__splatcache__
+
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "vao.h"
+#include "shader.h"
+
+using namespace std;
+
+/**
+ @brief Camera space copy of the visible splats of a model, rebuilt once per frame.
+ A capture pass transforms position, normal and radius, culls the splats outside
+ the frustum and writes the survivors compacted with transform feedback. The
+ splat passes then read this stream (cachedInput) instead of the model, so the
+ per point transform runs once per frame instead of once per pass.
+ */
+class SplatCache
+{
+
+private:
+    GLuint vaoID;
+    GLuint bufferID;
+    GLuint feedbackID;
+    GLsizeiptr capacity;    //bytes allocated in bufferID
+    bool initialized;
+    Shader captureShader;
+
+    void reserve(GLsizeiptr bytes);
+
+public:
+
+    //Constructors
+    SplatCache();
+
+    void init();
+    void capture(VAO *vao);
+    void draw();
+
+};
+
+#endif
@@ -26,6 +26,11 @@
  */
 
 #include "vao.h"
+#include "profiler.h"
+#include "progressive.h"
+#include "generator.h"
+#include "meshsampler.h"
+#include "file.h"
 
 #include <pcl/kdtree/kdtree_flann.h>
 
@@ -41,127 +46,293 @@ VAO::VAO(int numOfVertices, int numOfTriangles, vector<glm::vec3>vertices, vecto
     this->normals = normals;
     this->mode = mode;
     this->initialized = true;
+    this->resident = false;
+    this->numOfSeamVertices = 0;
+    this->validNormals = true;
 }
 
 
 
-VAO::VAO(CloudType::Ptr cloud)
+VAO::VAO(PointStore &&points)
 {
-    this->cloud = cloud;
-    this->numOfVertices = cloud->points.size ();
+    this->points = std::move(points);
+    this->numOfVertices = this->points.size();
+    this->numOfTriangles = 0;
     this->mode = GL_POINTS;
     this->initialized = true;
+    this->resident = false;
+    this->numOfSeamVertices = 0;
+    this->validNormals = hasValidNormals(this->points);
 }
 
 
-vector<float> VAO::getRadius()
+/**
+ @brief Sets the radius of every point to the distance to its 12th nearest
+ neighbour. The search runs on a PCL copy of the positions only, one block of
+ POINTSTORE_SEARCH_BLOCK points at a time.
+ @param[in,out] points
+ */
+void VAO::computeRadius(PointStore &points)
 {
-    vector<float> radius;
-
     int K = 12;
 
-    std::vector<glm::vec3> positions;
-    pcl::KdTreeFLANN<pcl::PointXYZRGBNormal> kdtree;
-    std::vector<int> k_indices;
-    std::vector<float> k_distances;
-
-    kdtree.setInputCloud(cloud->makeShared());
-
     std::vector<int> pointIdxNKNSearch(K);
     std::vector<float> pointNKNSquaredDistance(K);
 
-    for (unsigned int i = 0; i < cloud->size(); i++) {
+    size_t blocks = points.numOfSearchBlocks();
+    if (blocks > 1)
+        cout << points.size() << " points exceed the int indices of PCL, radii are searched within "
+             << blocks << " blocks of consecutive points." << endl;
+
+    points.radius.assign(points.size(), 0.0f);
+    for (size_t block = 0; block < blocks; block++) {
+        size_t first = block * POINTSTORE_SEARCH_BLOCK;
+        size_t count = min(POINTSTORE_SEARCH_BLOCK, points.size() - first);
+
+        pcl::PointCloud<pcl::PointXYZ>::Ptr positions (new pcl::PointCloud<pcl::PointXYZ>);
+        points.positionsToPCL(*positions, first, count);
+
+        pcl::KdTreeFLANN<pcl::PointXYZ> kdtree;
+        kdtree.setInputCloud(positions);
 
-        if ( kdtree.nearestKSearch (cloud->points[i], K, pointIdxNKNSearch, pointNKNSquaredDistance) > 0 )
-            radius.push_back(sqrt(pointNKNSquaredDistance[K-1]));
+        for (size_t i = 0; i < count; i++) {
+
+            int found = kdtree.nearestKSearch (positions->points[i], K, pointIdxNKNSearch, pointNKNSquaredDistance);
+            if (found > 0)
+                points.radius[first + i] = sqrt(pointNKNSquaredDistance[found-1]);
+
+        }
+    }
+}
+
+
+
+/**
+ @brief Estimates the normals and radii missing from the points, blocking, and
+ updates the buffers if they are on the GPU. Needed before reading them on the
+ host or timing frames, see requestAttributes otherwise.
+ */
+void VAO::computeAttributes()
+{
+    //A background computation already started is joined instead
+    if (attributeTask.valid()) {
+        attributeTask.wait();
+        updateAttributes();
+        return;
+    }
 
+    if (hasAttributes())
+        return;
 
+    if (!validNormals) {
+        estimateNormals(points);
+        validNormals = true;
     }
 
-    return radius;
+    if (points.radius.size() != points.size())
+        computeRadius();
+
+    uploadGeometry();
 }
 
 
 
 /**
- @brief Gets a random point inside a triangle defined by its vertices
- http://parametricplayground.blogspot.com.es/2011/02/random-points-distributed-inside.html
- @param v1, v2, v3 vertices of an triangle
- @returns point
+ @brief Starts estimating the missing normals and radii in a background thread,
+ on a copy of the positions. Does nothing if they are there or on their way.
+ updateAttributes takes them once they are ready.
  */
-glm::vec3 VAO::pickPoint(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3)
+void VAO::requestAttributes()
 {
-    glm::vec3 point;
+    if (hasAttributes() || attributeTask.valid())
+        return;
+
+    cout << "Estimating normals & radii of " << points.size() << " points in the background ..." << endl;
+
+    shared_ptr<PointStore> job(new PointStore);
+    job->resize(points.size());
+    job->x = points.x;
+    job->y = points.y;
+    job->z = points.z;
+
+    bool normals = !validNormals;
+    bool radii = points.radius.size() != points.size();
+
+    attributeTask = async(launch::async, [job, normals, radii] () {
+        if (normals)
+            estimateNormals(*job);
+        if (radii)
+            computeRadius(*job);
+    });
+    attributes = job;
+}
 
-    double c, a, b;
 
-    a = rand() / double(RAND_MAX);
-    b = rand() / double(RAND_MAX);
 
-    if (a + b > 1)
-    {
-        a = 1.0f - a;
-        b = 1.0f - b;
+/**
+ @brief Takes the normals and radii of requestAttributes if they are ready and,
+ when the buffers are resident, patches the geometry stream in place. Needs
+ the context current.
+ @returns true if the attributes changed
+ */
+bool VAO::updateAttributes()
+{
+    if (!attributeTask.valid() || attributeTask.wait_for(chrono::seconds(0)) != future_status::ready)
+        return false;
+
+    attributeTask.get();
+
+    if (!validNormals) {
+        points.nx.swap(attributes->nx);
+        points.ny.swap(attributes->ny);
+        points.nz.swap(attributes->nz);
+        validNormals = true;
     }
-    c = 1.0f - a - b;
+    if (points.radius.size() != points.size())
+        points.radius.swap(attributes->radius);
+    attributes.reset();
+
+    uploadGeometry();
+
+    cout << "Normals & radii of " << points.size() << " points ready." << endl;
+    return true;
+}
+
+
+
+/**
+ @brief Uploads the geometry stream again once the normals and radii change,
+ if the buffers are on the GPU. Colors are unchanged. Clouds with a range image
+ mesh take their attributes from the grid, so the seam buffer never needs it
+ */
+void VAO::uploadGeometry()
+{
+    if (!resident || vboID.empty())
+        return;
+
+    vector<vaoGeometry> geometryData(min(maxNumOfVertexByVBO(), points.size()));
 
-    point.x = (a * v1.x) + (b * v2.x) + (c * v3.x);
-    point.y = (a * v1.y) + (b * v2.y) + (c * v3.y);
-    point.z = (a * v1.z) + (b * v2.z) + (c * v3.z);
+    for (size_t i = 0; i < vboID.size(); i++) {
+        size_t first = maxNumOfVertexByVBO() * i;
+        size_t numberOfVertex = numOfVertexByVBO(i);
+        for (size_t j = 0; j < numberOfVertex; j++)
+            geometryData[j] = packGeometry(first + j);
 
-    return point;
+        glBindBuffer(GL_ARRAY_BUFFER, vboID[i]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0,
+                        (GLsizeiptr) (sizeof(vaoGeometry)*numberOfVertex),
+                        &geometryData[0]);
+    }
 }
 
 
+
+/**
+ @brief Free video memory reported by GL_NVX_gpu_memory_info or GL_ATI_meminfo
+ @returns KB, -1 if the driver does not tell
+ */
 int VAO::getFreeVideoMemory()
 {
     int availableKB[]={-1,-1,-1,-1};
     if(GLEW_NVX_gpu_memory_info)
-    {
         glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX,&availableKB[0]);
-        printf("NVidia card\n");
-    }
 
     if(GLEW_ATI_meminfo)
-    {
         glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI,availableKB);
-        printf("ATI card\n");
-    }
+
     return availableKB[0];
 }
 
 
+/**
+ @returns bytes of the buffers on the GPU, 0 if they are not uploaded
+ */
+size_t VAO::getGPUBytes()
+{
+    if (!resident)
+        return 0;
+
+    size_t meshBytes = 0;
+    if (!meshCount.empty())
+        meshBytes = sizeof(uint32_t) * (meshOffset.back() + meshCount.back())
+                  + (sizeof(vaoGeometry) + sizeof(vaoAppearance)) * numOfSeamVertices;
+
+    return (sizeof(vaoGeometry) + sizeof(vaoAppearance)) * points.size() + meshBytes;
+}
+
+
 
-int VAO::numOfVertexByVBO(int numOfVBO)
+/**
+ @param numOfVertex vertices of the whole cloud
+ @param numOfVBO index of the chunk
+ @returns vertices stored in that chunk
+ */
+size_t VAO::numOfVertexByVBO(size_t numOfVertex, size_t numOfVBO)
 {
-    if (cloud->size() - (maxNumOfVertexByVBO() * numOfVBO) >= maxNumOfVertexByVBO())
-        return maxNumOfVertexByVBO();
-    else
-        return cloud->size() - (maxNumOfVertexByVBO() * numOfVBO);
+    size_t first = maxNumOfVertexByVBO() * numOfVBO;
+    if (first >= numOfVertex)
+        return 0;
+
+    return min(maxNumOfVertexByVBO(), numOfVertex - first);
+}
+
+
+size_t VAO::maxNumOfVertexByVBO()
+{
+    return MAX_VBO_SIZE / sizeof(vaoGeometry);
 }
 
 
-int VAO::maxNumOfVertexByVBO()
+
+size_t VAO::numOfVBORequired(size_t numOfVertex)
 {
-    return floor(MAX_VBO_SIZE/(sizeof(vaoVertex)*1.0f));
+    return (numOfVertex + maxNumOfVertexByVBO() - 1) / maxNumOfVertexByVBO();
 }
 
 
 
-int VAO::numOfVBORequired(int numOfVertex)
+/**
+ @param i index of a point
+ @returns its entry in the geometry stream, with a null normal or radius if
+ they are still missing
+ */
+vaoGeometry VAO::packGeometry(size_t i)
 {
-    return ceil((numOfVertex*1.0f)/maxNumOfVertexByVBO());
+    vaoGeometry geometry;
+    geometry.position = points.getPosition(i);
+    geometry.normal = points.getNormal(i);
+    geometry.radius = (points.radius.size() == points.size()) ? points.radius[i] : 0.0f;
+    return geometry;
+}
+
+
+
+/**
+ @brief Converts the points to the layout of the geometry & appearance streams.
+ Missing normals and radii are left null, see computeAttributes.
+ @param geometryData output geometry stream
+ @param appearanceData output appearance stream
+ */
+void VAO::packVertices(vector<vaoGeometry> &geometryData, vector<vaoAppearance> &appearanceData)
+{
+    geometryData.resize(points.size());
+    appearanceData.resize(points.size());
+
+    for (size_t i = 0; i < points.size(); i++) {
+        geometryData[i] = packGeometry(i);
+        appearanceData[i].color = points.getColor(i);
+    }
 }
 
 
 
 void VAO::pushToGPU()
 {
-    vector<glm::vec3> vertices;
-    vector<glm::vec3> colors;
-    vector<glm::vec3> normals;
+    if (resident)
+        return;
 
-    vector<vaoVertex> vboData;
+    vector<vaoGeometry> geometryData;
+    vector<vaoAppearance> appearanceData;
 
     if (GLEW_ARB_vertex_buffer_object)
     {
@@ -172,55 +343,48 @@ void VAO::pushToGPU()
 
         // Bind our Vertex Array Object as the current used object
         glBindVertexArray(vaoID);
+        resident = true;
 
-        // Read cloud and get 3 vectors (vertices, colors and normals)
-        if (cloud != NULL) {
+        // Pack the points in the geometry & appearance streams
+        if (!points.empty()) {
 
-            vector<float> radius = getRadius();
+            size_t numberOfVBO = numOfVBORequired(points.size());
             
-            int numberOfVBO = numOfVBORequired(cloud->size());
-            
-            cout << sizeof(vaoVertex)*cloud->size() << " bytes." << endl;
+            cout << (sizeof(vaoGeometry) + sizeof(vaoAppearance))*points.size() << " bytes." << endl;
             cout << numberOfVBO << " VBO needed" << endl;
 
-            for (unsigned int i = 0; i < cloud->size(); i++) {
-                vaoVertex vertice;
-                vertice.position = glm::vec3(cloud->points[i].x,
-                                             cloud->points[i].y,
-                                             cloud->points[i].z);
+            packVertices(geometryData, appearanceData);
 
-                vertice.normal = glm::vec3(cloud->points[i].normal_x,
-                                           cloud->points[i].normal_y,
-                                           cloud->points[i].normal_z);
+            // Reserve a name for each buffer object, two streams per chunk.
+            vboID.resize(numberOfVBO);
+            appearanceVboID.resize(numberOfVBO);
+            glGenBuffers(numberOfVBO, &vboID[0]);
+            glGenBuffers(numberOfVBO, &appearanceVboID[0]);
 
-                vertice.color = glm::vec3(cloud->points[i].r/255.f,
-                                          cloud->points[i].g/255.f,
-                                          cloud->points[i].b/255.f);
-                vertice.radius = radius[i];
+            for (size_t i=0; i < numberOfVBO; i++) {
 
-                vboData.push_back(vertice);
-            }
+                size_t numberOfVertex = numOfVertexByVBO(i);
 
-            // Reserve a name for the buffer object.
-            vboID.resize(numberOfVBO);
-            glGenBuffers(numberOfVBO, &vboID[0]);
-            
-            for (int i=0; i < numberOfVBO; i++) {
-                // Bind it to the GL_ARRAY_BUFFER target.
                 glBindBuffer(GL_ARRAY_BUFFER, vboID[i]);
-                
-                int numberOfVertex = numOfVertexByVBO(i);
-                
                 glBufferData(GL_ARRAY_BUFFER,
-                             sizeof(vaoVertex)*numberOfVertex,
-                             &vboData[maxNumOfVertexByVBO()*i],
+                             (GLsizeiptr) (sizeof(vaoGeometry)*numberOfVertex),
+                             &geometryData[maxNumOfVertexByVBO()*i],
+                             GL_STATIC_DRAW);
+
+                glBindBuffer(GL_ARRAY_BUFFER, appearanceVboID[i]);
+                glBufferData(GL_ARRAY_BUFFER,
+                             (GLsizeiptr) (sizeof(vaoAppearance)*numberOfVertex),
+                             &appearanceData[maxNumOfVertexByVBO()*i],
                              GL_STATIC_DRAW);
             }
-            
+
             glEnableVertexAttribArray(0);
             glEnableVertexAttribArray(1);
             glEnableVertexAttribArray(2);
             glEnableVertexAttribArray(3);
+
+            if (points.hasMesh())
+                pushMeshToGPU(geometryData, appearanceData);
             
         }
 
@@ -234,116 +398,212 @@ void VAO::pushToGPU()
 
 
 
-void VAO::draw() {
-    
-    for (int i=0; i < vboID.size(); i++) {
-        glBindBuffer(GL_ARRAY_BUFFER, vboID[i]);
-        
-        int nBufferSize = 0;
-        glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &nBufferSize);
-        int originalVertexArraySize = ( nBufferSize / sizeof(vaoVertex) );
-        
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(0));
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)) );
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)*2) );
-        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(vaoVertex), BUFFER_OFFSET(sizeof(glm::vec3)*3) );
-        
-        glDrawArrays(mode, 0, originalVertexArraySize);
+/**
+ @brief Deletes the buffers and the vertex array, the host data is kept so
+ pushToGPU can upload them again
+ */
+void VAO::releaseGPU()
+{
+    if (!resident)
+        return;
+
+    if (!vboID.empty()) {
+        glDeleteBuffers(vboID.size(), &vboID[0]);
+        glDeleteBuffers(appearanceVboID.size(), &appearanceVboID[0]);
     }
+    if (!meshCount.empty()) {
+        glDeleteBuffers(1, &meshElementID);
+        glDeleteBuffers(1, &seamVboID);
+        glDeleteBuffers(1, &seamAppearanceVboID);
+    }
+    glDeleteVertexArrays(1, &vaoID);
+
+    vboID.clear();
+    appearanceVboID.clear();
+    meshOffset.clear();
+    meshCount.clear();
+    numOfSeamVertices = 0;
+    resident = false;
 }
 
 
 
-void VAO::sampleMesh(int samplesPerTriangle) {
+/**
+ @brief Uploads the range image mesh of the points. Triangles within a chunk
+ index its vertex buffers, the few crossing a chunk boundary are drawn from a
+ buffer of their own.
+ @param geometryData, appearanceData streams of the whole cloud, see packVertices
+ */
+void VAO::pushMeshToGPU(vector<vaoGeometry> &geometryData, vector<vaoAppearance> &appearanceData)
+{
+    size_t numberOfVBO = vboID.size();
+    size_t chunkSize = maxNumOfVertexByVBO();
+    const vector<uint32_t> &triangles = points.triangles;
+
+    vector<vector<uint32_t> > chunkIndices(numberOfVBO);
+    vector<vaoGeometry> seamGeometry;
+    vector<vaoAppearance> seamAppearance;
+
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        size_t chunk = triangles[i] / chunkSize;
+        if (triangles[i + 1] / chunkSize == chunk && triangles[i + 2] / chunkSize == chunk)
+            for (int k = 0; k < 3; k++)
+                chunkIndices[chunk].push_back(triangles[i + k] - chunk * chunkSize);
+        else
+            for (int k = 0; k < 3; k++) {
+                seamGeometry.push_back(geometryData[triangles[i + k]]);
+                seamAppearance.push_back(appearanceData[triangles[i + k]]);
+            }
+    }
 
-    if (mode == GL_TRIANGLES) {
+    vector<uint32_t> indices;
+    meshOffset.resize(numberOfVBO);
+    meshCount.resize(numberOfVBO);
+    for (size_t i = 0; i < numberOfVBO; i++) {
+        meshOffset[i] = indices.size();
+        meshCount[i] = (GLsizei) chunkIndices[i].size();
+        indices.insert(indices.end(), chunkIndices[i].begin(), chunkIndices[i].end());
+    }
+    numOfSeamVertices = (GLsizei) seamGeometry.size();
+
+    glGenBuffers(1, &meshElementID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshElementID);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 (GLsizeiptr) (sizeof(uint32_t)*indices.size()),
+                 indices.empty() ? NULL : &indices[0],
+                 GL_STATIC_DRAW);
+
+    glGenBuffers(1, &seamVboID);
+    glBindBuffer(GL_ARRAY_BUFFER, seamVboID);
+    glBufferData(GL_ARRAY_BUFFER,
+                 (GLsizeiptr) (sizeof(vaoGeometry)*seamGeometry.size()),
+                 seamGeometry.empty() ? NULL : &seamGeometry[0],
+                 GL_STATIC_DRAW);
+
+    glGenBuffers(1, &seamAppearanceVboID);
+    glBindBuffer(GL_ARRAY_BUFFER, seamAppearanceVboID);
+    glBufferData(GL_ARRAY_BUFFER,
+                 (GLsizeiptr) (sizeof(vaoAppearance)*seamAppearance.size()),
+                 seamAppearance.empty() ? NULL : &seamAppearance[0],
+                 GL_STATIC_DRAW);
+
+    cout << triangles.size() / 3 << " mesh triangles, " << numOfSeamVertices / 3 << " across chunks." << endl;
+}
 
-        this->numOfVertices = 0;
 
-        CloudType::Ptr cloud (new CloudType);
 
-        cloud->width = this->numOfTriangles * samplesPerTriangle;
-        cloud->height  = 1;
-        cloud->points.resize(cloud->width * cloud->height);
+void VAO::setAttribPointers(GLuint geometryVbo, GLuint appearanceVbo, vertexStream streams, size_t stride)
+{
+    GLsizei geometryStride = (GLsizei) (sizeof(vaoGeometry) * stride);
 
-        int line;
-        for (int i = 0; i < this->numOfTriangles; i++) {
-            for (int j = 0; j < samplesPerTriangle; j++) {
-                line = i*3;
+    glBindBuffer(GL_ARRAY_BUFFER, geometryVbo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(0));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(sizeof(glm::vec3)) );
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, geometryStride, BUFFER_OFFSET(sizeof(glm::vec3)*2) );
 
-                glm::vec3 point = pickPoint(this->vertices[line], this->vertices[line+1], this->vertices[line+2]);
-                cloud->points[this->numOfVertices].x = point.x;
-                cloud->points[this->numOfVertices].y = point.y;
-                cloud->points[this->numOfVertices].z = point.z;
-                cloud->points[this->numOfVertices].normal_x = this->normals[i].x;
-                cloud->points[this->numOfVertices].normal_y = this->normals[i].y;
-                cloud->points[this->numOfVertices].normal_z = this->normals[i].z;
-                cloud->points[this->numOfVertices].r = this->colors[line].r * 255;
-                cloud->points[this->numOfVertices].g = this->colors[line].g * 255;
-                cloud->points[this->numOfVertices].b = this->colors[line].b * 255;
+    if (streams & APPEARANCE_STREAM) {
+        glBindBuffer(GL_ARRAY_BUFFER, appearanceVbo);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, (GLsizei) (sizeof(vaoAppearance) * stride), BUFFER_OFFSET(0));
+    }
+}
 
-                this->numOfVertices++;
-            }
-        }
 
-        this->cloud = cloud;
 
-        this->mode = GL_POINTS;
+/**
+ @brief Draws every chunk of the cloud, fetching only the requested streams.
+ Attributes of a stream left out keep their current generic value. While
+ Progressive refines the view only every stride-th point is drawn.
+ @param streams vertex streams read by the shader in use
+ */
+void VAO::draw(vertexStream streams) {
 
-    }
+    if (streams & APPEARANCE_STREAM)
+        glEnableVertexAttribArray(1);
+    else
+        glDisableVertexAttribArray(1);
+
+    size_t stride = Progressive::getStride();
+
+    for (size_t i=0; i < vboID.size(); i++) {
+        setAttribPointers(vboID[i], appearanceVboID[i], streams, stride);
 
+        //A chunk never exceeds MAX_VBO_SIZE, so its count fits a GLsizei
+        size_t count = (numOfVertexByVBO(i) + stride - 1) / stride;
+        glDrawArrays(mode, 0, (GLsizei) count);
+        Profiler::countDraw(count);
+    }
 }
 
-void VAO::sampleSphere(int numOfSamples)
-{
-    double x, y, z;
 
-    this->numOfTriangles = 0;
-    this->numOfVertices = 0;
 
-    CloudType::Ptr cloud (new CloudType);
+/**
+ @brief Draws the range image mesh as triangles, one indexed draw per chunk
+ plus one for the triangles across chunks. Needs hasMesh().
+ */
+void VAO::drawMesh() {
 
-    cloud->width = numOfSamples;
-    cloud->height  = 1;
-    cloud->points.resize(cloud->width * cloud->height);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshElementID);
 
-    for (int i = 0; i < numOfSamples; i += 2) {
-        //x^2 + y^2 + z^2 = 1
+    for (size_t i=0; i < meshCount.size(); i++) {
+        if (meshCount[i] == 0)
+            continue;
 
-        x = rand() / double(RAND_MAX) * 2 - 1;
-        y = rand() / double(RAND_MAX) * 2 - 1;
+        setAttribPointers(vboID[i], appearanceVboID[i], ALL_STREAMS);
+        glDrawElements(GL_TRIANGLES, meshCount[i], GL_UNSIGNED_INT, BUFFER_OFFSET(sizeof(uint32_t)*meshOffset[i]));
+        Profiler::countDraw(meshCount[i]);
+    }
 
-        while (sqrt(pow(x, 2) + pow(y, 2)) > 1.0)
-            y = rand() / double(RAND_MAX) * 2 - 1;
+    if (numOfSeamVertices > 0) {
+        setAttribPointers(seamVboID, seamAppearanceVboID, ALL_STREAMS);
+        glDrawArrays(GL_TRIANGLES, 0, numOfSeamVertices);
+        Profiler::countDraw(numOfSeamVertices);
+    }
+}
 
-            z = sqrt(1 - pow(x, 2) - pow(y, 2));
 
-            cloud->points[i].x = x;
-            cloud->points[i].y = y;
-            cloud->points[i].z = z;
-            cloud->points[i].normal_x = x;
-            cloud->points[i].normal_y = y;
-            cloud->points[i].normal_z = z;
-            cloud->points[i].r = 0;
-            cloud->points[i].g = 0;
-            cloud->points[i].b = 255;
 
-            cloud->points[i+1].x = x;
-            cloud->points[i+1].y = y;
-            cloud->points[i+1].z = -z;
-            cloud->points[i+1].normal_x = x;
-            cloud->points[i+1].normal_y = y;
-            cloud->points[i+1].normal_z = -z;
-            cloud->points[i+1].r = 255;
-            cloud->points[i+1].g = 0;
-            cloud->points[i+1].b = 0;
+/**
+ @brief Replaces the triangles with surfels spread by area, see MeshSampler
+ @param samplesPerTriangle average samples per triangle
+ */
+void VAO::sampleMesh(int samplesPerTriangle) {
 
-            this->numOfVertices = this->numOfVertices + 2;
+    if (mode == GL_TRIANGLES) {
 
-            }
+        triangleMesh mesh;
+        mesh.vertices = this->vertices;
+        mesh.colors = this->colors;
+        mesh.normals = this->normals;
+        for (int i = 0; i < this->numOfTriangles * 3; i++)
+            mesh.indices.push_back(i);
 
+        MeshSampler::sample(mesh, this->numOfTriangles * samplesPerTriangle, 0, points);
+        this->numOfVertices = points.size();
 
-    this->cloud = cloud;
+        //The triangles are not needed anymore
+        vector<glm::vec3>().swap(this->vertices);
+        vector<glm::vec3>().swap(this->colors);
+        vector<glm::vec3>().swap(this->normals);
+
+        this->mode = GL_POINTS;
+        this->validNormals = true;
+
+    }
 
+}
+
+/**
+ @brief Replaces the points with a unit sphere from Generator, blue on top and red below
+ @param numOfSamples points of the sphere
+ */
+void VAO::sampleSphere(int numOfSamples)
+{
+    generatorSpec spec = {SPHERE, (size_t) numOfSamples, 0};
+    Generator::generate(spec, 0, spec.numOfPoints, points);
+
+    this->numOfTriangles = 0;
+    this->numOfVertices = points.size();
     this->mode = GL_POINTS;
+    this->validNormals = true;
 }
@@ -30,16 +30,28 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <future>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
-#include <pcl/point_types.h>
-#include <pcl/point_cloud.h>
+#include "pointstore.h"
 
 #define BUFFER_OFFSET(bytes) ((GLubyte*) NULL + (bytes))
 
+namespace stream
+{
+    //Vertex streams a pass can fetch, bitmask
+    enum vertexStream {
+        GEOMETRY_STREAM     = 1,   //position, normal & radius
+        APPEARANCE_STREAM   = 2,   //color
+        ALL_STREAMS         = 3
+    };
+}
+
 using namespace std;
+using namespace stream;
 
 
 struct vaoVertex {
@@ -49,49 +61,92 @@ struct vaoVertex {
     float radius;
 };
 
+//Split layout on the GPU: geometry and appearance live in separate buffers
+struct vaoGeometry {
+    glm::vec3 position;
+    glm::vec3 normal;
+    float radius;
+};
+
+struct vaoAppearance {
+    glm::vec3 color;
+};
+
 class VAO
 {
 
-private:
+protected:
     GLuint vaoID;
-    vector<GLuint> vboID;
+    vector<GLuint> vboID;           //geometry stream, one per chunk
+    vector<GLuint> appearanceVboID; //appearance stream, one per chunk
     bool initialized;
-    int numOfVertices;
+    bool resident;                  //buffers on the GPU
+    size_t numOfVertices;
     int numOfTriangles;
-    vector<glm::vec3> vertices; //DEPRECATED
-    vector<glm::vec3> colors;   //DEPRECATED
-    vector<glm::vec3> normals;  //DEPRECATED
+    vector<glm::vec3> vertices; //triangles to sample, released by sampleMesh
+    vector<glm::vec3> colors;
+    vector<glm::vec3> normals;
     GLenum mode;
-    typedef pcl::PointCloud<pcl::PointXYZRGBNormal> CloudType;
-    vector<float> radius;
-    CloudType::Ptr cloud;
+    PointStore points;              //host copy, so the buffers can be uploaded again without the KNN search
+    GLuint meshElementID;           //triangles within a chunk, chunk relative indices, chunk after chunk
+    vector<size_t> meshOffset;      //first index of each chunk in meshElementID
+    vector<GLsizei> meshCount;      //indices of each chunk
+    GLuint seamVboID, seamAppearanceVboID; //triangles across chunks, with their vertices copied
+    GLsizei numOfSeamVertices;
+    bool validNormals;              //every point has a normal, otherwise they are estimated on demand
+    shared_ptr<PointStore> attributes; //normals & radii computed in the background, see requestAttributes
+    future<void> attributeTask;
 
-    vector<float> getRadius();
-    glm::vec3 pickPoint(glm::vec3 v1, glm::vec3 v2, glm::vec3 v3);
     
     
-    int numOfVertexByVBO(int numOfVBO);
-    int maxNumOfVertexByVBO();
-    int numOfVBORequired(int numOfVertex);
-    int getFreeVideoMemory();
+    size_t numOfVertexByVBO(size_t numOfVBO) { return numOfVertexByVBO(points.size(), numOfVBO); };
+    void setAttribPointers(GLuint geometryVbo, GLuint appearanceVbo, vertexStream streams, size_t stride = 1);
+    void pushMeshToGPU(vector<vaoGeometry> &geometryData, vector<vaoAppearance> &appearanceData);
+    vaoGeometry packGeometry(size_t i);
+    void uploadGeometry();
 
 public:
 
     //Constructors
-    VAO() { initialized = false; };
+    VAO() { initialized = false; resident = false; numOfSeamVertices = 0; validNormals = true; };
     VAO(int numOfVertices, int numOfTriangles, vector<glm::vec3>vertices, vector<glm::vec3>colors, vector<glm::vec3>normals, GLenum mode);
-    VAO(CloudType::Ptr cloud);
+    VAO(PointStore &&points);
+
+    //Move only, the points are never duplicated
+    VAO(const VAO &) = delete;
+    VAO &operator=(const VAO &) = delete;
+    VAO(VAO &&) = default;
+    VAO &operator=(VAO &&) = default;
 
-    ~VAO() {}; //delete cloud };
+    virtual ~VAO() {};
 
     //Getters & Setters
     GLuint getVAOid() { return vaoID; };
     GLenum getMode() { return mode; };
-    CloudType::Ptr getCloud() {return cloud; };
+    size_t getNumOfVertices() { return numOfVertices; };
+    PointStore &getPoints() { return points; };
 
     bool isValid () { return initialized; };
-    void pushToGPU();
-    void draw();
+    bool isResident() { return resident; };
+    bool hasMesh() { return resident && !meshCount.empty(); };
+    virtual size_t getGPUBytes();
+    static int getFreeVideoMemory();
+
+    //Chunking of the vertex buffers, 64-bit safe
+    static size_t maxNumOfVertexByVBO();
+    static size_t numOfVBORequired(size_t numOfVertex);
+    static size_t numOfVertexByVBO(size_t numOfVertex, size_t numOfVBO);
+    static void computeRadius(PointStore &points);
+    void computeRadius() { computeRadius(points); };
+    bool hasAttributes() { return validNormals && points.radius.size() == points.size(); };
+    void computeAttributes();
+    void requestAttributes();
+    bool updateAttributes();
+    void packVertices(vector<vaoGeometry> &geometryData, vector<vaoAppearance> &appearanceData);
+    virtual void pushToGPU();
+    virtual void releaseGPU();
+    virtual void draw(vertexStream streams = ALL_STREAMS);
+    void drawMesh();
 
     void sampleMesh(int samplesPerTriangle);
     void sampleSphere(int numOfSamples);